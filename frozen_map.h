@@ -0,0 +1,693 @@
+#ifndef FROZEN_MAP_H_INC
+#define FROZEN_MAP_H_INC
+
+#include "static_table.h"
+
+#ifdef NO_STDLIB
+#error "frozen_map allocates and uses threads, so it needs the standard library"
+#endif
+
+#include <algorithm>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+template <class K, class V>
+class mapped_map;
+
+/**
+ * An immutable map that is built once at runtime.
+ *
+ * This is for lookup tables that are only known at startup, such as
+ * ones loaded from a configuration file.  It picks its search strategy
+ * the same way static_search::automatic does for static_map, and runs
+ * the same lookup code (the algorithms in static_table_impl that do not
+ * need a compile-time size):
+ *
+ * - integral or enumeration keys in arithmetic progression are found
+ *   by computing the index directly, in O(1).
+ * - keys that are given in sorted order are binary searched.
+ * - keys that static_hash can hash get a minimal perfect hash, which
+ *   makes lookups O(1).
+ * - other keys that can be compared with < are sorted, then binary
+ *   searched.
+ * - anything else, including duplicate keys that cannot be sorted or
+ *   hashed, is searched linearly.  The first of equal keys wins.
+ *
+ * Keys, values and the search structure share one allocation.  For
+ * large inputs, hashing the keys and sorting them are spread over
+ * std::thread::hardware_concurrency() threads, so code using this
+ * header needs to link with the platform's thread library.
+ *
+ * The interface is the runtime subset of static_map's, and at_index()
+ * and key_at_index() use input order.
+ *
+ * \tparam K The type of the keys
+ * \tparam V The type of the values
+ */
+template <class K, class V>
+class frozen_map {
+	//reads and writes the layout below as a file
+	friend class mapped_map<K, V>;
+public:
+	///The type of the keys in the map
+	typedef K key_type;
+	///The type of the mapped values in the map
+	typedef V value_type;
+	///Shorthand form for the type of this object
+	typedef frozen_map<K, V> this_type;
+
+	///inputs at least this large are built with several threads
+	static constexpr unsigned parallel_min = 1U << 15;
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+
+	//don't document this section
+	#ifndef DOXYGEN
+
+	enum kind { linear_kind, direct_kind, sorted_kind, hashed_kind, permuted_kind };
+
+	typedef std::vector<std::pair<K, V>> staging;
+
+	//whether K can be searched with a strategy
+	static bool supports(std::uint32_t how) {
+		switch (how) {
+		case linear_kind:
+			return true;
+		case direct_kind:
+			return std::is_integral<K>::value || std::is_enum<K>::value;
+		case sorted_kind:
+		case permuted_kind:
+			return impl::comparable<K>::value;
+		case hashed_kind:
+			return impl::hashable<K>::value;
+		default:
+			return false;
+		}
+	}
+
+	//the keys of the staged entries, as a generator
+	struct key_at {
+		const staging* items;
+		const K& operator()(unsigned i) const {
+			return (*items)[i].first;
+		}
+	};
+
+	//compares staged keys for phf_place()
+	struct same_key {
+		const staging* items;
+		bool operator()(unsigned i, unsigned j) const {
+			return (*items)[i].first == (*items)[j].first;
+		}
+	};
+
+	//scratch space for phf_place()
+	struct phf_scratch {
+		std::vector<unsigned> start;
+		std::vector<unsigned> members;
+		std::vector<unsigned> by_size;
+		std::vector<unsigned> count;
+		std::unique_ptr<bool[]> used;
+
+		phf_scratch(unsigned n, unsigned b) : start(b + 1), members(n),
+			by_size(b), count((b > n + 2) ? b : n + 2), used(new bool[n]) {}
+	};
+
+	//how many threads to build n entries with
+	static unsigned build_threads(unsigned n) {
+		const unsigned cores = std::thread::hardware_concurrency();
+		const unsigned most = n / parallel_min;
+		return (cores == 0 || most < 2) ? 1 : (cores < most) ? cores : most;
+	}
+
+	//run fn(begin, end) over t equal parts of [0, n), fn(0, ...) on
+	//this thread
+	template <class Fn>
+	static void parallel_for(unsigned n, unsigned t, Fn fn) {
+		std::vector<std::thread> pool;
+		for (unsigned k = 1; k < t; ++k) {
+			pool.emplace_back(fn, part(n, t, k), part(n, t, k + 1));
+		}
+		fn(0, part(n, t, 1));
+		for (std::thread& th : pool) {
+			th.join();
+		}
+	}
+
+	static unsigned part(unsigned n, unsigned t, unsigned k) {
+		return static_cast<unsigned>(static_cast<std::uint64_t>(n) * k / t);
+	}
+
+	//n % d through one multiplication (Lemire et al.), exact for all
+	//32 bit n and d, with magic == fastmod_magic(d)
+	static std::uint64_t fastmod_magic(unsigned d) {
+		return std::numeric_limits<std::uint64_t>::max() / d + 1;
+	}
+
+	static unsigned fastmod(std::uint32_t n, std::uint64_t magic, unsigned d) {
+	#ifdef __SIZEOF_INT128__
+		__extension__ typedef unsigned __int128 wide;
+		return static_cast<unsigned>((static_cast<wide>(magic * n) * d) >> 64);
+	#else
+		return (void)magic, n % d;
+	#endif
+	}
+
+	//the strategies, each only instantiated for keys that support it
+
+	template <class T = K>
+	typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value,
+		bool>::type
+	try_direct(const staging& items) {
+		affine = impl::affine_build<K>(key_at{ &items }, length);
+		return affine.ok;
+	}
+
+	template <class T = K>
+	typename std::enable_if<!std::is_integral<T>::value && !std::is_enum<T>::value,
+		bool>::type
+	try_direct(const staging&) {
+		return false;
+	}
+
+	template <class T = K>
+	typename std::enable_if<impl::comparable<T>::value, bool>::type
+	try_sorted(const staging& items) const {
+		for (unsigned i = 1; i < length; ++i) {
+			if (items[i].first < items[i - 1].first) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <class T = K>
+	typename std::enable_if<!impl::comparable<T>::value, bool>::type
+	try_sorted(const staging&) const {
+		return length < 2;
+	}
+
+	template <class T = K>
+	typename std::enable_if<impl::hashable<T>::value, bool>::type
+	try_hash(const staging& items, std::vector<unsigned>& order,
+		std::vector<unsigned>& slot_of, std::vector<std::uint32_t>& disp)
+	{
+		const unsigned b = length + 1;
+		std::vector<std::uint64_t> h(length);
+		phf_scratch w(length, b);
+		disp.assign(b, 0);
+		order.resize(length);
+		slot_of.resize(length);
+		const unsigned t = build_threads(length);
+		for (unsigned attempt = 0; attempt < impl::phf_max_seeds; ++attempt) {
+			const std::uint64_t s = impl::phf_seed(attempt);
+			parallel_for(length, t, [&](unsigned begin, unsigned end) {
+				for (unsigned i = begin; i < end; ++i) {
+					h[i] = static_hash<K>{}(items[i].first, s);
+				}
+			});
+			const impl::phf_result placed = impl::phf_place(h,
+				length, b, same_key{ &items }, w, disp, order, slot_of);
+			if (placed != impl::phf_retry) {
+				seed = s;
+				buckets = b;
+				return placed == impl::phf_placed;
+			}
+		}
+		return false;
+	}
+
+	template <class T = K>
+	typename std::enable_if<!impl::hashable<T>::value, bool>::type
+	try_hash(const staging&, std::vector<unsigned>&, std::vector<unsigned>&,
+		std::vector<std::uint32_t>&)
+	{
+		return false;
+	}
+
+	//sort the input positions by key, in parts, then merge the parts
+	//pairwise.  Ties go to the earlier position, so the result does
+	//not depend on the number of threads.
+	template <class T = K>
+	typename std::enable_if<impl::comparable<T>::value, bool>::type
+	try_sort(const staging& items, std::vector<unsigned>& order,
+		std::vector<unsigned>& slot_of) const
+	{
+		order.resize(length);
+		std::iota(order.begin(), order.end(), 0U);
+		auto less = [&items](unsigned a, unsigned b) {
+			return items[a].first < items[b].first ||
+				(!(items[b].first < items[a].first) && a < b);
+		};
+		const unsigned t = build_threads(length);
+		parallel_for(length, t, [&](unsigned begin, unsigned end) {
+			std::sort(order.begin() + begin, order.begin() + end, less);
+		});
+		for (unsigned width = 1; width < t; width *= 2) {
+			std::vector<std::thread> pool;
+			for (unsigned k = 0; k + width < t; k += 2 * width) {
+				const unsigned last = (k + 2 * width < t) ? k + 2 * width : t;
+				pool.emplace_back([&, k, width, last] {
+					std::inplace_merge(order.begin() + part(length, t, k),
+						order.begin() + part(length, t, k + width),
+						order.begin() + part(length, t, last), less);
+				});
+			}
+			for (std::thread& th : pool) {
+				th.join();
+			}
+		}
+		//like static_search::sort, this needs unique keys
+		for (unsigned r = 1; r < length; ++r) {
+			if (!(items[order[r - 1]].first < items[order[r]].first)) {
+				order.clear();
+				return false;
+			}
+		}
+		slot_of.resize(length);
+		for (unsigned r = 0; r < length; ++r) {
+			slot_of[order[r]] = r;
+		}
+		return true;
+	}
+
+	template <class T = K>
+	typename std::enable_if<!impl::comparable<T>::value, bool>::type
+	try_sort(const staging&, std::vector<unsigned>&, std::vector<unsigned>&) const {
+		return false;
+	}
+
+	//the searches, which return the slot of k or length
+
+	template <class T = K>
+	typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value,
+		unsigned>::type
+	find_direct(const K& k) const {
+		const std::uint64_t i = impl::affine_index(affine, static_cast<std::uint64_t>(k));
+		return (i < length) ? static_cast<unsigned>(i) : length;
+	}
+
+	template <class T = K>
+	typename std::enable_if<!std::is_integral<T>::value && !std::is_enum<T>::value,
+		unsigned>::type
+	find_direct(const K&) const {
+		return length;
+	}
+
+	template <class T = K>
+	typename std::enable_if<impl::comparable<T>::value, unsigned>::type
+	find_sorted(const K& k) const {
+		return impl::binary_find(keys_, k, length);
+	}
+
+	template <class T = K>
+	typename std::enable_if<!impl::comparable<T>::value, unsigned>::type
+	find_sorted(const K&) const {
+		return length;
+	}
+
+	//the same slot as impl::phf_slot(), with the divisions replaced
+	template <class T = K>
+	typename std::enable_if<impl::hashable<T>::value, unsigned>::type
+	find_hashed(const K& k) const {
+		const std::uint64_t h = static_hash<K>{}(k, seed);
+		const std::uint32_t d = disp[fastmod(static_cast<std::uint32_t>(h >> 32),
+			buckets_magic, buckets)];
+		const unsigned s = fastmod(impl::mix32(static_cast<std::uint32_t>(h) ^ d),
+			length_magic, length);
+		return (keys_[s] == k) ? s : length;
+	}
+
+	template <class T = K>
+	typename std::enable_if<!impl::hashable<T>::value, unsigned>::type
+	find_hashed(const K&) const {
+		return length;
+	}
+
+	unsigned find_linear(const K& k) const {
+		unsigned i = 0;
+		while (i < length && !(keys_[i] == k)) {
+			++i;
+		}
+		return i;
+	}
+
+	unsigned find_slot(const K& k) const {
+		switch (how) {
+		case direct_kind:
+			return find_direct(k);
+		case sorted_kind:
+		case permuted_kind:
+			return find_sorted(k);
+		case hashed_kind:
+			return find_hashed(k);
+		default:
+			return find_linear(k);
+		}
+	}
+
+	//the slot of the entry at input position i
+	unsigned slot(unsigned i) const {
+		return slot_of ? slot_of[i] : i;
+	}
+
+	static std::size_t align_up(std::size_t x, std::size_t a) {
+		return (x + a - 1) / a * a;
+	}
+
+	void build(staging& items) {
+		if (items.size() >= std::numeric_limits<unsigned>::max() / 2) {
+			throw std::length_error("frozen_map is limited to 2^31 entries");
+		}
+		length = static_cast<unsigned>(items.size());
+		std::vector<unsigned> order;
+		std::vector<unsigned> slots;
+		std::vector<std::uint32_t> displacements;
+		//the same priority as static_search::automatic
+		if (length == 0) {
+			how = linear_kind;
+		}
+		else if (try_direct(items)) {
+			how = direct_kind;
+		}
+		else if (try_sorted(items)) {
+			how = sorted_kind;
+		}
+		else if (try_hash(items, order, slots, displacements)) {
+			how = hashed_kind;
+		}
+		else {
+			//a failed try_hash leaves its displacements behind
+			displacements.clear();
+			buckets = 0;
+			seed = 0;
+			if (try_sort(items, order, slots)) {
+				how = permuted_kind;
+			}
+			else {
+				how = linear_kind;
+				order.clear();
+				slots.clear();
+			}
+		}
+		length_magic = fastmod_magic(length ? length : 1);
+		buckets_magic = fastmod_magic(buckets ? buckets : 1);
+
+		//one block: keys, values, slot_of, disp
+		const std::size_t values_at = align_up(length * sizeof(K), alignof(V));
+		const std::size_t slots_at = align_up(values_at + length * sizeof(V),
+			alignof(unsigned));
+		const std::size_t disp_at = align_up(slots_at + slots.size() * sizeof(unsigned),
+			alignof(std::uint32_t));
+		const std::size_t size = disp_at + displacements.size() * sizeof(std::uint32_t);
+		if (size == 0) {
+			return;
+		}
+		unsigned char* bytes = static_cast<unsigned char*>(::operator new(size));
+		block = bytes;
+		keys_ = reinterpret_cast<K*>(bytes);
+		values_ = reinterpret_cast<V*>(bytes + values_at);
+		if (!slots.empty()) {
+			slot_of = reinterpret_cast<unsigned*>(bytes + slots_at);
+			std::copy(slots.begin(), slots.end(), slot_of);
+		}
+		if (!displacements.empty()) {
+			disp = reinterpret_cast<std::uint32_t*>(bytes + disp_at);
+			std::copy(displacements.begin(), displacements.end(), disp);
+		}
+		unsigned made_keys = 0;
+		unsigned made_values = 0;
+		try {
+			for (; made_keys < length; ++made_keys) {
+				const unsigned i = order.empty() ? made_keys : order[made_keys];
+				::new (static_cast<void*>(keys_ + made_keys)) K(std::move(items[i].first));
+			}
+			for (; made_values < length; ++made_values) {
+				const unsigned i = order.empty() ? made_values : order[made_values];
+				::new (static_cast<void*>(values_ + made_values)) V(std::move(items[i].second));
+			}
+		}
+		catch (...) {
+			destroy(made_keys, made_values);
+			throw;
+		}
+	}
+
+	//a map without a block is a view of memory it does not own (see
+	//mapped_map)
+	void destroy(unsigned made_keys, unsigned made_values) {
+		if (block) {
+			for (unsigned i = 0; i < made_values; ++i) {
+				values_[i].~V();
+			}
+			for (unsigned i = 0; i < made_keys; ++i) {
+				keys_[i].~K();
+			}
+			::operator delete(block);
+		}
+		reset();
+	}
+
+	void reset() {
+		block = nullptr;
+		keys_ = nullptr;
+		values_ = nullptr;
+		slot_of = nullptr;
+		disp = nullptr;
+		length = 0;
+		buckets = 0;
+		how = linear_kind;
+	}
+
+	void steal(frozen_map& other) {
+		block = other.block;
+		keys_ = other.keys_;
+		values_ = other.values_;
+		slot_of = other.slot_of;
+		disp = other.disp;
+		length = other.length;
+		buckets = other.buckets;
+		length_magic = other.length_magic;
+		buckets_magic = other.buckets_magic;
+		seed = other.seed;
+		affine = other.affine;
+		how = other.how;
+		other.reset();
+	}
+
+	#endif
+
+	///the single allocation that holds everything below
+	void* block = nullptr;
+	///the keys, in slot order
+	K* keys_ = nullptr;
+	///the values, in slot order
+	V* values_ = nullptr;
+	///the slot of each input position, or null if they are the same
+	unsigned* slot_of = nullptr;
+	///the displacement of each bucket of the perfect hash
+	std::uint32_t* disp = nullptr;
+	///the number of entries
+	unsigned length = 0;
+	///the number of buckets of the perfect hash
+	unsigned buckets = 0;
+	///fastmod() magic numbers for length and buckets
+	std::uint64_t length_magic = 0;
+	std::uint64_t buckets_magic = 0;
+	///the static_hash seed of the perfect hash
+	std::uint64_t seed = 0;
+	///the progression of the keys, if they are in one
+	impl::affine_layout affine{};
+	///the search strategy
+	kind how = linear_kind;
+public:
+	/**
+	 * Build a map from a range of pairs.
+	 *
+	 * The elements need first and second members, as std::pair and
+	 * the elements of std::map do.  Building takes O(N lg(N)) time.
+	 *
+	 * \param first The start of the range
+	 * \param last The end of the range
+	 *
+	 * \throws std::length_error there are 2^31 or more entries
+	 */
+	template <class InputIt>
+	frozen_map(InputIt first, InputIt last) {
+		staging items;
+		for (; first != last; ++first) {
+			items.emplace_back((*first).first, (*first).second);
+		}
+		build(items);
+	}
+
+	/**
+	 * Build a map from a list of pairs.
+	 *
+	 * \param init The (key, value) pairs
+	 */
+	frozen_map(std::initializer_list<std::pair<K, V>> init)
+		: frozen_map(init.begin(), init.end()) {}
+
+	///an empty map
+	frozen_map() = default;
+
+	frozen_map(const frozen_map&) = delete;
+	frozen_map& operator=(const frozen_map&) = delete;
+
+	///take the entries of another map, which is left empty
+	frozen_map(frozen_map&& other) noexcept {
+		steal(other);
+	}
+
+	///take the entries of another map, which is left empty
+	frozen_map& operator=(frozen_map&& other) noexcept {
+		if (this != &other) {
+			destroy(length, length);
+			steal(other);
+		}
+		return *this;
+	}
+
+	~frozen_map() {
+		destroy(length, length);
+	}
+
+	/**
+	 * Look up a key in the map.
+	 *
+	 * This is O(1) for direct and hashed maps, O(lg(N)) for sorted and
+	 * permuted maps and O(N) otherwise.
+	 *
+	 * \param k A key
+	 * \return The value that k maps to.
+	 *
+	 * \throws key_not_found_error key is not in this map
+	 */
+	const value_type& operator[](const key_type& k) const {
+		const unsigned s = find_slot(k);
+		return (s != length) ? values_[s] : throw key_not_found_error{};
+	}
+
+	/**
+	 * Look up a key in the map without throwing.
+	 *
+	 * \param k A key
+	 * \return A pointer to the value that k maps to, or nullptr if k is
+	 * not in this map.
+	 */
+	const value_type* find(const key_type& k) const {
+		const unsigned s = find_slot(k);
+		return (s != length) ? values_ + s : nullptr;
+	}
+
+	/**
+	 * Check if a key is in the map.
+	 *
+	 * \param k A key
+	 * \return True if k is in this map, false otherwise
+	 */
+	bool contains(const key_type& k) const {
+		return find_slot(k) != length;
+	}
+
+	/**
+	 * Look up a key in the map, with a fallback value.
+	 *
+	 * \param k A key
+	 * \param fallback The value to return if k is not in this map
+	 * \return The value that k maps to, or fallback
+	 */
+	value_type get_or(const key_type& k, value_type fallback) const {
+		const unsigned s = find_slot(k);
+		return (s != length) ? values_[s] : fallback;
+	}
+
+	/**
+	 * Get the value at a certain input position.
+	 *
+	 * This is not bounds checked.
+	 *
+	 * \param i The position in the input range
+	 * \return The value of the ith input pair
+	 */
+	const value_type& at_index(unsigned i) const {
+		return values_[slot(i)];
+	}
+
+	/**
+	 * Get the key at a certain input position.
+	 *
+	 * This is not bounds checked.
+	 *
+	 * \param i The position in the input range
+	 * \return The key of the ith input pair
+	 */
+	const key_type& key_at_index(unsigned i) const {
+		return keys_[slot(i)];
+	}
+
+	/**
+	 * Look up several keys at once.
+	 *
+	 * This has the same contract as static_map::lookup().
+	 *
+	 * \param keys The keys to look up
+	 * \param values Receives the n values
+	 * \param n The number of keys
+	 * \param found Optionally receives whether each key was found
+	 *
+	 * \throws key_not_found_error a key is not in this map and found is
+	 * null
+	 */
+	void lookup(const key_type* keys, value_type* values, unsigned n,
+		bool* found = nullptr) const
+	{
+		for (unsigned j = 0; j < n; ++j) {
+			const unsigned s = find_slot(keys[j]);
+			if (found) {
+				found[j] = (s != length);
+			}
+			if (s != length) {
+				values[j] = values_[s];
+			}
+			else if (!found) {
+				throw key_not_found_error{};
+			}
+		}
+	}
+
+	///The number of (key, value) pairs in the map
+	unsigned size() const {
+		return length;
+	}
+
+	///if the keys were given in sorted order and are binary searched
+	bool sorted() const {
+		return how == sorted_kind;
+	}
+
+	///if lookups use a minimal perfect hash
+	bool hashed() const {
+		return how == hashed_kind;
+	}
+
+	///if the keys were sorted when the map was built
+	bool permuted() const {
+		return how == permuted_kind;
+	}
+
+	///if lookups compute the index directly
+	bool direct() const {
+		return how == direct_kind;
+	}
+};
+
+#endif
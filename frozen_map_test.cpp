@@ -0,0 +1,108 @@
+#include "frozen_map.h"
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+struct point {
+    int x;
+    int y;
+    bool operator==(const point& p) const {
+        return x == p.x && y == p.y;
+    }
+};
+
+//every key maps to its value and misses are misses, whatever strategy
+//the map picked
+template <class K, class V>
+bool agrees(const frozen_map<K, V>& map, const std::vector<std::pair<K, V>>& items,
+    const std::vector<K>& misses)
+{
+    for (unsigned i = 0; i < items.size(); ++i) {
+        if (!(map[items[i].first] == items[i].second) || !map.contains(items[i].first)
+            || !(map.key_at_index(i) == items[i].first)
+            || !(map.at_index(i) == items[i].second)) {
+            return false;
+        }
+    }
+    for (const K& k : misses) {
+        if (map.find(k) != nullptr || map.contains(k)) {
+            return false;
+        }
+    }
+    return map.size() == items.size();
+}
+
+std::vector<std::pair<unsigned, unsigned>> scrambled(unsigned n) {
+    std::vector<std::pair<unsigned, unsigned>> items;
+    for (unsigned i = 0; i < n; ++i) {
+        const unsigned k = i * 2654435761U;
+        items.emplace_back(k, k / 3);
+    }
+    return items;
+}
+
+int main() {
+    std::vector<std::pair<int, int>> strided;
+    for (int i = 0; i < 100; ++i) {
+        strided.emplace_back(1000 - 7 * i, i);
+    }
+    frozen_map<int, int> direct(strided.begin(), strided.end());
+
+    std::map<std::string, int> config{ {"alpha", 1}, {"beta", 2}, {"gamma", 3} };
+    frozen_map<std::string, int> sorted(config.begin(), config.end());
+
+    const auto small = scrambled(1000);
+    frozen_map<unsigned, unsigned> hashed(small.begin(), small.end());
+    //big enough to hash and sort with several threads
+    const auto large = scrambled(4 * frozen_map<unsigned, unsigned>::parallel_min);
+    frozen_map<unsigned, unsigned> hashed_large(large.begin(), large.end());
+
+    std::vector<std::pair<std::string, int>> words{ {"pear", 1}, {"fig", 2},
+        {"apple", 3}, {"kiwi", 4} };
+    frozen_map<std::string, int> permuted(words.begin(), words.end());
+    std::vector<std::pair<double, int>> fractions;
+    for (unsigned i = 0; i < 3 * frozen_map<double, int>::parallel_min; ++i) {
+        fractions.emplace_back(((i * 7919U) % 100003U) / 8.0, static_cast<int>(i));
+    }
+    frozen_map<double, int> permuted_large(fractions.begin(), fractions.end());
+
+    std::vector<std::pair<point, int>> points{ {{1, 2}, 3}, {{0, 0}, 0}, {{2, 1}, 3} };
+    frozen_map<point, int> linear(points.begin(), points.end());
+
+    frozen_map<unsigned, unsigned> moved(std::move(hashed_large));
+    frozen_map<int, char> listed{ {3, 'c'}, {1, 'a'}, {2, 'b'} };
+    const frozen_map<int, char> empty;
+
+    std::cout << "Strategies: " << direct.direct() << sorted.sorted() << hashed.hashed()
+        << moved.hashed() << permuted.permuted() << permuted_large.permuted()
+        << !(linear.sorted() || linear.hashed() || linear.permuted() || linear.direct())
+        << '\n';
+    std::cout << "Lookups agree: "
+        << (agrees(direct, strided, {0, 1000 - 7 * 100, 1001, 999})
+            && agrees(sorted, std::vector<std::pair<std::string, int>>(config.begin(),
+                config.end()), {"", "delta", "alphas"})
+            && agrees(hashed, small, {1, 2, 3})
+            && agrees(moved, large, {1, 2, 3})
+            && agrees(permuted, words, {"banana", "zebra"})
+            && agrees(permuted_large, fractions, {-1.0, 0.01, 1e9})
+            && agrees(linear, points, {{2, 2}}))
+        << '\n';
+    std::cout << "Moved from is empty: " << (hashed_large.size() == 0
+        && !hashed_large.contains(small[1].first)) << '\n';
+    std::cout << "Listed: " << listed[1] << listed[2] << listed[3]
+        << " get_or: " << listed.get_or(4, '-') << empty.get_or(0, '-') << '\n';
+    try {
+        std::cout << "Missing key: " << sorted["delta"] << '\n';
+    }
+    catch (key_not_found_error& e) {
+        std::cout << "Not found\n";
+    }
+    std::vector<unsigned> keys{ small[5].first, 17, small[9].first };
+    unsigned values[3] = {};
+    bool found[3];
+    hashed.lookup(keys.data(), values, 3, found);
+    std::cout << "Batch: " << found[0] << found[1] << found[2] << ' '
+        << (values[0] == small[5].second && values[2] == small[9].second) << '\n';
+    return 0;
+}
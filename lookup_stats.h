@@ -0,0 +1,278 @@
+#ifndef LOOKUP_STATS_H_INC
+#define LOOKUP_STATS_H_INC
+
+#include "static_table.h"
+
+#ifdef NO_STDLIB
+#error "lookup_stats uses threads and locks, so it needs the standard library"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+/**
+ * What the lookups in one table did, added up over every thread.
+ *
+ * This is a snapshot: it is a plain copy of the counters at the time
+ * it was collected, and does not change afterwards.
+ */
+struct lookup_stats {
+	///lookups that took more steps than this share the last bucket
+	static constexpr unsigned max_steps = 16;
+
+	///the name of the table, from the Name of static_instrument::counted
+	const char* name;
+	///the number of lookups, found or not
+	std::uint64_t lookups;
+	///the number of lookups that did not find their key
+	std::uint64_t misses;
+	///steps[i] is the number of lookups that took i probes (see
+	///static_table_impl::probe_steps), or at least max_steps probes for
+	///the last bucket
+	std::uint64_t steps[max_steps + 1];
+
+	///the share of the lookups that missed, or 0 if there were none
+	double miss_ratio() const {
+		return lookups ? static_cast<double>(misses) / lookups : 0.0;
+	}
+
+	///the average number of probes per lookup, or 0 if there were none
+	double mean_steps() const {
+		std::uint64_t total = 0;
+		for (unsigned i = 0; i <= max_steps; ++i) {
+			total += i * steps[i];
+		}
+		return lookups ? static_cast<double>(total) / lookups : 0.0;
+	}
+};
+
+std::vector<lookup_stats> collect_lookup_stats();
+
+template <class Table>
+lookup_stats lookup_stats_of();
+
+/**
+ * The bookkeeping behind static_instrument::counted.
+ *
+ * Each thread counts the lookups in each table in a block of its own,
+ * so the lookups never write to shared memory.  The blocks of a table
+ * are listed in a registry, which the collecting functions add up
+ * under a lock.  When a thread exits, its counts are added to the
+ * registry and its block is dropped from the list.
+ *
+ * The counters are atomics that only their own thread writes, with
+ * relaxed loads and stores, so an increment compiles to a plain
+ * add and a collection running in another thread reads them without
+ * a data race.
+ */
+class lookup_stats_impl {
+	template <class Name>
+	friend struct static_instrument::counted;
+	friend std::vector<lookup_stats> collect_lookup_stats();
+	template <class Table>
+	friend lookup_stats lookup_stats_of();
+
+	//don't document this section
+	#ifndef DOXYGEN
+
+	typedef std::atomic<std::uint64_t> counter;
+
+	static void bump(counter& c) {
+		c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	//one thread's counts for one table
+	struct block {
+		counter lookups;
+		counter misses;
+		counter steps[lookup_stats::max_steps + 1];
+
+		block() : lookups(0), misses(0) {
+			for (counter& c : steps) {
+				c.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		void add_to(lookup_stats& to) const {
+			to.lookups += lookups.load(std::memory_order_relaxed);
+			to.misses += misses.load(std::memory_order_relaxed);
+			for (unsigned i = 0; i <= lookup_stats::max_steps; ++i) {
+				to.steps[i] += steps[i].load(std::memory_order_relaxed);
+			}
+		}
+	};
+
+	//every thread's counts for one table
+	struct registry {
+		std::mutex lock;
+		std::vector<const block*> live;
+		//the counts of the threads that have exited
+		lookup_stats retired;
+
+		explicit registry(const char* name) : retired{ name, 0, 0, {} } {}
+
+		lookup_stats total() {
+			std::lock_guard<std::mutex> hold(lock);
+			lookup_stats sum = retired;
+			for (const block* b : live) {
+				b->add_to(sum);
+			}
+			return sum;
+		}
+	};
+
+	//the registries of all the tables that have been looked up
+	static std::mutex& tables_lock() {
+		static std::mutex lock;
+		return lock;
+	}
+
+	static std::vector<registry*>& tables() {
+		static std::vector<registry*> all;
+		return all;
+	}
+
+	//the registries are never destroyed, so that threads that exit
+	//during static destruction can still hand in their counts
+	template <class Table>
+	static registry& registry_of() {
+		static registry* const r = enroll(new registry(Table::instrument_type::name()));
+		return *r;
+	}
+
+	static registry* enroll(registry* r) {
+		std::lock_guard<std::mutex> hold(tables_lock());
+		tables().push_back(r);
+		return r;
+	}
+
+	//a block that is listed in its registry while its thread runs
+	template <class Table>
+	struct listed_block : block {
+		listed_block() {
+			registry& r = registry_of<Table>();
+			std::lock_guard<std::mutex> hold(r.lock);
+			r.live.push_back(this);
+		}
+
+		~listed_block() {
+			registry& r = registry_of<Table>();
+			std::lock_guard<std::mutex> hold(r.lock);
+			this->add_to(r.retired);
+			r.live.erase(std::find(r.live.begin(), r.live.end(), this));
+		}
+	};
+
+	template <class Table>
+	static block& local() {
+		static thread_local listed_block<Table> mine;
+		return mine;
+	}
+
+	#endif
+};
+
+namespace static_instrument {
+	/**
+	 * Count the lookups in a table, per thread.
+	 *
+	 * A static_map or static_table that is given this tag records
+	 * every lookup: how many there were, how many missed and how many
+	 * probes each took.  The counts are collected with
+	 * collect_lookup_stats(), lookup_stats_of() and
+	 * dump_lookup_stats().  Tables of the same type share their counts.
+	 *
+	 * Recording is not constexpr, so the lookups of a counted table can
+	 * not be used in constant expressions.
+	 *
+	 * \tparam Name A type with a static member function name() that
+	 * returns the name of the table, as a const char* that lives as long
+	 * as the program
+	 */
+	template <class Name>
+	struct counted {
+		///the name of the tables that use this tag
+		static const char* name() {
+			return Name::name();
+		}
+
+		///called with the slot each lookup found; counts the lookup and
+		///returns the slot unchanged
+		template <class Table, class Map, class K>
+		static unsigned record(const Map& map, const K& key, unsigned slot) {
+			typedef lookup_stats_impl impl;
+			impl::block& b = impl::local<Table>();
+			impl::bump(b.lookups);
+			if (slot == Table::length) {
+				impl::bump(b.misses);
+			}
+			//compared rather than passed to std::min, which would take
+			//max_steps by reference and need a definition of it
+			const unsigned steps = static_table_impl::probe_steps(map, key, slot);
+			impl::bump(b.steps[steps < lookup_stats::max_steps ? steps : lookup_stats::max_steps]);
+			return slot;
+		}
+	};
+}
+
+/**
+ * Collect the counts of every counted table that has been looked up.
+ *
+ * Lookups that run while this collects may or may not be included.
+ *
+ * \return The counts of each table, over all threads, in the order the
+ * tables were first looked up
+ */
+inline std::vector<lookup_stats> collect_lookup_stats() {
+	std::vector<lookup_stats_impl::registry*> all;
+	{
+		std::lock_guard<std::mutex> hold(lookup_stats_impl::tables_lock());
+		all = lookup_stats_impl::tables();
+	}
+	std::vector<lookup_stats> stats;
+	for (lookup_stats_impl::registry* r : all) {
+		stats.push_back(r->total());
+	}
+	return stats;
+}
+
+/**
+ * Collect the counts of one counted table.
+ *
+ * \tparam Table The type of the table, a static_map or static_table
+ * with a static_instrument::counted tag
+ * \return The counts of the table over all threads, all 0 if it has not
+ * been looked up
+ */
+template <class Table>
+lookup_stats lookup_stats_of() {
+	return lookup_stats_impl::registry_of<Table>().total();
+}
+
+/**
+ * Write the counts of every counted table that has been looked up.
+ *
+ * Each table gets one line with its name, the number of lookups and
+ * misses, the average number of probes and then the non-empty buckets
+ * of the probe histogram as probes:lookups.
+ *
+ * \param out The stream to write to
+ */
+inline void dump_lookup_stats(std::ostream& out) {
+	for (const lookup_stats& s : collect_lookup_stats()) {
+		out << s.name << ": " << s.lookups << " lookups, " << s.misses
+			<< " misses, " << s.mean_steps() << " probes on average,";
+		for (unsigned i = 0; i <= lookup_stats::max_steps; ++i) {
+			if (s.steps[i]) {
+				out << ' ' << i << (i == lookup_stats::max_steps ? "+:" : ":") << s.steps[i];
+			}
+		}
+		out << '\n';
+	}
+}
+
+#endif
@@ -0,0 +1,58 @@
+//built by lookup_stats_overhead_test.sh against this tree and against
+//a revision from before static_instrument, which checks that the
+//default static_instrument::none leaves the lookups unchanged.  Only
+//uses what both revisions have
+#include "static_table.h"
+
+constexpr unsigned num = 1000;
+
+struct keymap_scrambled {
+    constexpr unsigned operator()(unsigned i) {
+        return (i * 2654435761U) ^ 12345;
+    }
+};
+
+struct keymap_sorted {
+    constexpr unsigned operator()(unsigned i) {
+        return 2*i + 1;
+    }
+};
+
+struct keymap {
+    constexpr unsigned operator()(unsigned i) {
+        return i;
+    }
+};
+
+struct valuemap {
+    constexpr unsigned operator()(unsigned key) {
+        return key * 3;
+    }
+};
+
+constexpr static_map<num, keymap_scrambled, valuemap, static_search::perfect_hash> map_hashed{};
+constexpr static_map<num, keymap_sorted, valuemap, static_search::eytzinger> map_eytzinger{};
+constexpr static_map<num, keymap_sorted, valuemap, static_search::binary> map_binary{};
+constexpr static_map<num, keymap, valuemap, static_search::linear> map_linear{};
+constexpr static_table<num, valuemap> table{};
+
+unsigned look_up_hashed(unsigned k) {
+    return map_hashed[k];
+}
+
+unsigned look_up_eytzinger(unsigned k) {
+    return map_eytzinger.get_or(k, 0);
+}
+
+unsigned look_up_binary(unsigned k) {
+    const unsigned* v = map_binary.find(k);
+    return v ? *v : 0;
+}
+
+bool contains_linear(unsigned k) {
+    return map_linear.contains(k);
+}
+
+unsigned look_up_table(unsigned i) {
+    return table[i];
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+#build lookup_stats_overhead_test.cpp against this tree and against the
+#headers of an older revision, and check that both give the same machine
+#code, i.e. that the default static_instrument::none costs nothing.
+#the revision defaults to the parent of the commit that added
+#static_instrument; pass another as the first argument once the lookups
+#themselves change.  set CXX to use another compiler.
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++14 -O2"
+SOURCE=lookup_stats_overhead_test.cpp
+HEADERS="static_table.h metaprogramming.h metaprog_support.h"
+status=0
+
+check() {
+    if [ "$2" = 1 ]; then
+        echo "$1: 1"
+    else
+        echo "$1: 0"
+        status=1
+    fi
+}
+
+#the disassembly, without addresses
+disassemble() {
+    objdump -d --no-show-raw-insn "$1" | sed -e 's/^ *[0-9a-f]*://' -e '/file format/d'
+}
+
+revision=${1:-$(git log --format=%H -S'namespace static_instrument' -- static_table.h | tail -n 1)^}
+old=$(mktemp -d)
+for header in $HEADERS; do
+    git show "$revision:$header" > "$old/$header" || status=1
+done
+check "Headers found at $revision" "$([ $status = 0 ] && echo 1)"
+#next to its copy of the source, as "" includes look beside the source first
+cp $SOURCE "$old/"
+
+if ! $CXX $FLAGS -c $SOURCE -o "$old/new.o"; then
+    check "Builds" 0
+elif ! $CXX $FLAGS -c "$old/$SOURCE" -o "$old/old.o"; then
+    check "Builds at $revision" 0
+else
+    disassemble "$old/new.o" > "$old/new.s"
+    disassemble "$old/old.o" > "$old/old.s"
+    check "Same code as $revision" "$(cmp -s "$old/new.s" "$old/old.s" && echo 1)"
+fi
+
+rm -rf "$old"
+exit $status
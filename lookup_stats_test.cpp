@@ -0,0 +1,128 @@
+#include "lookup_stats.h"
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+constexpr unsigned num = 100;
+constexpr unsigned threads = 4;
+
+struct keymap {
+    constexpr unsigned operator()(unsigned i) {
+        return i;
+    }
+};
+
+struct keymap_scrambled {
+    constexpr unsigned operator()(unsigned i) {
+        return (i * 37) % num;
+    }
+};
+
+struct valuemap {
+    constexpr unsigned operator()(unsigned key) {
+        return key*key;
+    }
+};
+
+struct name_linear {
+    static const char* name() {
+        return "linear";
+    }
+};
+
+struct name_hashed {
+    static const char* name() {
+        return "hashed";
+    }
+};
+
+struct name_table {
+    static const char* name() {
+        return "table";
+    }
+};
+
+typedef static_map<num, keymap, valuemap, static_search::linear,
+    static_filter::none, static_instrument::counted<name_linear>> counted_linear;
+typedef static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::none, static_instrument::counted<name_hashed>> counted_hashed;
+typedef static_table<num, valuemap, static_instrument::counted<name_table>> counted_table;
+
+//the tables are still built at compile time
+constexpr counted_linear map_linear;
+constexpr counted_hashed map_hashed;
+constexpr counted_table table;
+
+static_assert(counted_linear::instrumented && !static_map<num, keymap, valuemap>::instrumented,
+    "instrumented flag");
+static_assert(sizeof(counted_hashed) == sizeof(static_map<num, keymap_scrambled, valuemap>),
+    "counting takes no space in the map");
+
+//each thread looks up keys 0 to 9 of the linear map, finds them at
+//slots 0 to 9, then misses once; and looks up the whole table, which
+//is not bounds checked, and then once past its end
+void look_up(unsigned& sum) {
+    for (unsigned i = 0; i < 10; ++i) {
+        sum += map_linear[i] + *map_hashed.find(i);
+    }
+    sum += map_linear.get_or(num, 1) + map_hashed.contains(num);
+    unsigned keys[num];
+    unsigned values[num];
+    for (unsigned i = 0; i < num; ++i) {
+        keys[i] = i;
+    }
+    table.lookup(keys, values, num);
+    sum += values[num - 1] + table.get_or(num, 0);
+}
+
+int main() {
+    std::vector<std::thread> pool;
+    std::vector<unsigned> sums(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back(look_up, std::ref(sums[t]));
+    }
+    //half of the threads are done before the counts are collected,
+    //half of them are still running
+    for (unsigned t = 0; t < threads / 2; ++t) {
+        pool[t].join();
+    }
+    const lookup_stats linear = lookup_stats_of<counted_linear>();
+    for (unsigned t = threads / 2; t < threads; ++t) {
+        pool[t].join();
+    }
+    unsigned main_sum = 0;
+    look_up(main_sum);
+
+    const lookup_stats hashed = lookup_stats_of<counted_hashed>();
+    const lookup_stats direct = lookup_stats_of<counted_table>();
+    std::cout << "Threads agree: " << (sums[0] == main_sum && sums[threads - 1] == main_sum)
+        << '\n';
+    //the threads that had not finished may or may not be counted yet
+    std::cout << "Partial counts: " << (linear.lookups >= 11 * threads / 2
+        && linear.lookups <= 11 * threads) << '\n';
+    std::cout << "Linear: " << lookup_stats_of<counted_linear>().lookups << ' '
+        << lookup_stats_of<counted_linear>().misses << '\n';
+    std::cout << "Hashed: " << hashed.lookups << ' ' << hashed.misses << ' '
+        << hashed.steps[1] << '\n';
+    std::cout << "Table: " << (direct.lookups == (num + 1) * (threads + 1)
+        && direct.misses == threads + 1) << '\n';
+
+    //found at slots 0 to 9, 1 to 10 probes; a miss scans all of them
+    const lookup_stats all = lookup_stats_of<counted_linear>();
+    bool histogram = all.steps[0] == 0 && all.steps[lookup_stats::max_steps] == threads + 1;
+    for (unsigned i = 1; i <= 10; ++i) {
+        histogram = histogram && all.steps[i] == threads + 1;
+    }
+    std::cout << "Histogram: " << histogram << ' ' << all.mean_steps() << '\n';
+
+    std::ostringstream out;
+    dump_lookup_stats(out);
+    std::cout << out.str();
+    std::cout << "Tables: " << collect_lookup_stats().size() << '\n';
+
+    //an uninstrumented lookup is still a constant expression
+    constexpr static_map<num, keymap, valuemap> plain;
+    static_assert(plain[7] == 49 && !plain.contains(num), "plain lookup");
+    return 0;
+}
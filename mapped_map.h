@@ -0,0 +1,480 @@
+#ifndef MAPPED_MAP_H_INC
+#define MAPPED_MAP_H_INC
+
+#include "frozen_map.h"
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Exception class that indicates a file is not a usable mapped_map
+ */
+class bad_mapped_file : public std::runtime_error {
+public:
+    explicit bad_mapped_file(const char* why) : std::runtime_error(
+            std::string("Not a static table file for this map type: ") + why
+    ) {}
+};
+
+/**
+ * The header at the start of a mapped_map file.
+ *
+ * The file holds the layout of a frozen_map: the header, then the keys,
+ * the values, the slot of each input position and the displacements of
+ * the perfect hash, each starting at a multiple of mapped_file_header::align
+ * bytes.  Everything is in the byte order of the machine that wrote it,
+ * which byte_order records.
+ */
+struct mapped_file_header {
+	///the first 8 bytes of every file
+	static constexpr char signature[9] = "STATTBL\n";
+	///the current format version
+	static constexpr std::uint32_t current = 1;
+	///the alignment of each section
+	static constexpr std::uint64_t align = 64;
+
+	///signature, without the terminating null
+	char magic[8];
+	///the format version
+	std::uint32_t version;
+	///0x01020304 as written by the writer
+	std::uint32_t byte_order;
+	///sizeof(K)
+	std::uint32_t key_size;
+	///sizeof(V)
+	std::uint32_t value_size;
+	///the search strategy: linear, direct, sorted, hashed or permuted
+	std::uint32_t kind;
+	///the number of entries
+	std::uint32_t length;
+	///the number of buckets of the perfect hash
+	std::uint32_t buckets;
+	///the trailing zeros of the stride, for direct lookups
+	std::uint32_t affine_shift;
+	///the static_hash seed of the perfect hash
+	std::uint64_t seed;
+	///the first key, for direct lookups
+	std::uint64_t affine_origin;
+	///the inverse of the odd part of the stride, for direct lookups
+	std::uint64_t affine_inverse;
+	///the offsets of the sections, 0 if a section is absent
+	std::uint64_t keys_at;
+	std::uint64_t values_at;
+	std::uint64_t slots_at;
+	std::uint64_t disp_at;
+	///the size of the whole file
+	std::uint64_t size;
+};
+
+#ifndef DOXYGEN
+constexpr char mapped_file_header::signature[9];
+constexpr std::uint32_t mapped_file_header::current;
+constexpr std::uint64_t mapped_file_header::align;
+#endif
+
+/**
+ * A read-only view of a lookup table in a file.
+ *
+ * Big static_map and static_table instances are slow to compile and
+ * every program that includes them gets its own copy.  Instead, a
+ * generator program can write the table once with write_mapped(), and
+ * other programs map the file with this class.  Opening it is one mmap
+ * and a check of the header: nothing is parsed or copied, lookups read
+ * the mapped pages in place, and all the processes that map the file
+ * share its page cache.
+ *
+ * The interface is frozen_map's, and lookups run frozen_map's code.
+ * at_index() and key_at_index() use the order of the written map.
+ *
+ * K and V must be trivially copyable, must not hold pointers (so not
+ * static_string), and must be the same types, on the same platform, as
+ * those of the map that was written.  Only the header is checked when
+ * the file is opened; the rest of the file is trusted.  The file must
+ * not be changed while it is mapped: write a new file and rename it
+ * over the old one instead.
+ *
+ * \tparam K The type of the keys
+ * \tparam V The type of the values
+ */
+template <class K, class V>
+class mapped_map {
+	static_assert(std::is_trivially_copyable<K>::value &&
+		std::is_trivially_copyable<V>::value,
+		"mapped_map keys and values must be trivially copyable");
+	//they are, but they point into the program that wrote the file
+	static_assert(!std::is_same<K, static_string>::value &&
+		!std::is_same<V, static_string>::value,
+		"mapped_map cannot store static_string keys or values");
+public:
+	///The type of the keys in the map
+	typedef K key_type;
+	///The type of the mapped values in the map
+	typedef V value_type;
+	///Shorthand form for the type of this object
+	typedef mapped_map<K, V> this_type;
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+	typedef frozen_map<K, V> frozen;
+
+	//don't document this section
+	#ifndef DOXYGEN
+
+	static std::uint64_t align_up(std::uint64_t x) {
+		return (x + mapped_file_header::align - 1) / mapped_file_header::align *
+			mapped_file_header::align;
+	}
+
+	//check that count elements of type T fit at offset
+	template <class T>
+	static const T* section(const unsigned char* data, std::uint64_t size,
+		std::uint64_t offset, std::uint64_t count)
+	{
+		if (offset < sizeof(mapped_file_header) || offset > size ||
+			count > (size - offset) / sizeof(T) ||
+			reinterpret_cast<std::uintptr_t>(data + offset) % alignof(T) != 0) {
+			throw bad_mapped_file("section out of bounds or misaligned");
+		}
+		return reinterpret_cast<const T*>(data + offset);
+	}
+
+	//point map at the layout in [data, data + size)
+	void view(const void* memory, std::size_t size) {
+		const unsigned char* data = static_cast<const unsigned char*>(memory);
+		mapped_file_header h;
+		if (size < sizeof(h)) {
+			throw bad_mapped_file("too short");
+		}
+		std::memcpy(&h, data, sizeof(h));
+		if (std::memcmp(h.magic, mapped_file_header::signature, sizeof(h.magic)) != 0) {
+			throw bad_mapped_file("bad signature");
+		}
+		if (h.version != mapped_file_header::current) {
+			throw bad_mapped_file("unsupported version");
+		}
+		if (h.byte_order != 0x01020304U || h.key_size != sizeof(K) ||
+			h.value_size != sizeof(V)) {
+			throw bad_mapped_file("written for another key, value or byte order");
+		}
+		if (!frozen::supports(h.kind) || h.size > size ||
+			h.length >= std::numeric_limits<unsigned>::max() / 2) {
+			throw bad_mapped_file("bad header");
+		}
+		const bool slotted = (h.kind == frozen::hashed_kind ||
+			h.kind == frozen::permuted_kind);
+		if (h.kind == frozen::hashed_kind && h.buckets == 0) {
+			throw bad_mapped_file("bad header");
+		}
+		frozen& m = map;
+		if (h.length != 0) {
+			m.keys_ = const_cast<K*>(section<K>(data, h.size, h.keys_at, h.length));
+			m.values_ = const_cast<V*>(section<V>(data, h.size, h.values_at, h.length));
+		}
+		if (slotted) {
+			m.slot_of = const_cast<unsigned*>(
+				section<unsigned>(data, h.size, h.slots_at, h.length));
+		}
+		if (h.kind == frozen::hashed_kind) {
+			m.disp = const_cast<std::uint32_t*>(
+				section<std::uint32_t>(data, h.size, h.disp_at, h.buckets));
+		}
+		m.length = h.length;
+		m.buckets = h.buckets;
+		m.length_magic = frozen::fastmod_magic(h.length ? h.length : 1);
+		m.buckets_magic = frozen::fastmod_magic(h.buckets ? h.buckets : 1);
+		m.seed = h.seed;
+		m.affine.ok = (h.kind == frozen::direct_kind);
+		m.affine.origin = h.affine_origin;
+		m.affine.inverse = h.affine_inverse;
+		m.affine.shift = h.affine_shift;
+		m.how = static_cast<typename frozen::kind>(h.kind);
+	}
+
+	static void pad(std::ostream& out, std::uint64_t& at, std::uint64_t to) {
+		for (; at < to; ++at) {
+			out.put('\0');
+		}
+	}
+
+	static void put(std::ostream& out, std::uint64_t& at, const void* p, std::uint64_t bytes) {
+		out.write(static_cast<const char*>(p), static_cast<std::streamsize>(bytes));
+		at += bytes;
+	}
+
+	void unmap() {
+		if (mapping) {
+			::munmap(mapping, mapping_size);
+		}
+		mapping = nullptr;
+		mapping_size = 0;
+	}
+
+	#endif
+
+	///the lookup engine, viewing the mapped memory
+	frozen map;
+	///the mapping, or null if the memory belongs to someone else
+	void* mapping = nullptr;
+	///the size of the mapping
+	std::size_t mapping_size = 0;
+public:
+	/**
+	 * Map a file.
+	 *
+	 * \param path The file, as written by write_mapped()
+	 *
+	 * \throws std::system_error the file could not be opened or mapped
+	 * \throws bad_mapped_file the file was not written for this map type
+	 */
+	explicit mapped_map(const char* path) {
+		const int fd = ::open(path, O_RDONLY);
+		if (fd < 0) {
+			throw std::system_error(errno, std::generic_category(), path);
+		}
+		struct stat st;
+		if (::fstat(fd, &st) != 0) {
+			const int error = errno;
+			::close(fd);
+			throw std::system_error(error, std::generic_category(), path);
+		}
+		mapping_size = static_cast<std::size_t>(st.st_size);
+		if (mapping_size < sizeof(mapped_file_header)) {
+			::close(fd);
+			throw bad_mapped_file("too short");
+		}
+		void* p = ::mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+		const int error = errno;
+		::close(fd);
+		if (p == MAP_FAILED) {
+			throw std::system_error(error, std::generic_category(), path);
+		}
+		mapping = p;
+		try {
+			view(mapping, mapping_size);
+		}
+		catch (...) {
+			unmap();
+			throw;
+		}
+	}
+
+	/**
+	 * View a file that is already in memory.
+	 *
+	 * The memory must outlive this object and be aligned to
+	 * mapped_file_header::align bytes.
+	 *
+	 * \param data The contents of a file written by write_mapped()
+	 * \param size The size of the file
+	 *
+	 * \throws bad_mapped_file the file was not written for this map type
+	 */
+	mapped_map(const void* data, std::size_t size) {
+		view(data, size);
+	}
+
+	mapped_map(const mapped_map&) = delete;
+	mapped_map& operator=(const mapped_map&) = delete;
+
+	///take the mapping of another map, which is left empty
+	mapped_map(mapped_map&& other) noexcept : map(std::move(other.map)),
+		mapping(other.mapping), mapping_size(other.mapping_size)
+	{
+		other.mapping = nullptr;
+		other.mapping_size = 0;
+	}
+
+	///take the mapping of another map, which is left empty
+	mapped_map& operator=(mapped_map&& other) noexcept {
+		if (this != &other) {
+			unmap();
+			map = std::move(other.map);
+			mapping = other.mapping;
+			mapping_size = other.mapping_size;
+			other.mapping = nullptr;
+			other.mapping_size = 0;
+		}
+		return *this;
+	}
+
+	~mapped_map() {
+		unmap();
+	}
+
+	/**
+	 * Look up a key in the map.
+	 *
+	 * \param k A key
+	 * \return The value that k maps to.
+	 *
+	 * \throws key_not_found_error key is not in this map
+	 */
+	const value_type& operator[](const key_type& k) const {
+		return map[k];
+	}
+
+	///find() of frozen_map
+	const value_type* find(const key_type& k) const {
+		return map.find(k);
+	}
+
+	///contains() of frozen_map
+	bool contains(const key_type& k) const {
+		return map.contains(k);
+	}
+
+	///get_or() of frozen_map
+	value_type get_or(const key_type& k, value_type fallback) const {
+		return map.get_or(k, fallback);
+	}
+
+	///at_index() of frozen_map
+	const value_type& at_index(unsigned i) const {
+		return map.at_index(i);
+	}
+
+	///key_at_index() of frozen_map
+	const key_type& key_at_index(unsigned i) const {
+		return map.key_at_index(i);
+	}
+
+	///lookup() of frozen_map
+	void lookup(const key_type* keys, value_type* values, unsigned n,
+		bool* found = nullptr) const
+	{
+		map.lookup(keys, values, n, found);
+	}
+
+	///The number of (key, value) pairs in the map
+	unsigned size() const {
+		return map.size();
+	}
+
+	///if lookups use a minimal perfect hash
+	bool hashed() const {
+		return map.hashed();
+	}
+
+	///if lookups compute the index directly
+	bool direct() const {
+		return map.direct();
+	}
+
+	/**
+	 * Write a frozen_map in the format that this class maps.
+	 *
+	 * The stream should be opened in binary mode.  Errors are reported
+	 * through the stream's state.
+	 *
+	 * \param out The stream to write to
+	 * \param m The map to write
+	 */
+	static void write(std::ostream& out, const frozen& m) {
+		mapped_file_header h{};
+		std::memcpy(h.magic, mapped_file_header::signature, sizeof(h.magic));
+		h.version = mapped_file_header::current;
+		h.byte_order = 0x01020304U;
+		h.key_size = sizeof(K);
+		h.value_size = sizeof(V);
+		h.kind = m.how;
+		h.length = m.length;
+		h.buckets = m.buckets;
+		h.seed = m.seed;
+		h.affine_origin = m.affine.origin;
+		h.affine_inverse = m.affine.inverse;
+		h.affine_shift = m.affine.shift;
+		h.keys_at = align_up(sizeof(h));
+		h.values_at = align_up(h.keys_at + m.length * sizeof(K));
+		std::uint64_t end = h.values_at + m.length * sizeof(V);
+		if (m.slot_of) {
+			h.slots_at = align_up(end);
+			end = h.slots_at + m.length * sizeof(unsigned);
+		}
+		if (m.disp) {
+			h.disp_at = align_up(end);
+			end = h.disp_at + m.buckets * sizeof(std::uint32_t);
+		}
+		h.size = end;
+		std::uint64_t at = 0;
+		put(out, at, &h, sizeof(h));
+		pad(out, at, h.keys_at);
+		put(out, at, m.keys_, m.length * sizeof(K));
+		pad(out, at, h.values_at);
+		put(out, at, m.values_, m.length * sizeof(V));
+		if (m.slot_of) {
+			pad(out, at, h.slots_at);
+			put(out, at, m.slot_of, m.length * sizeof(unsigned));
+		}
+		if (m.disp) {
+			pad(out, at, h.disp_at);
+			put(out, at, m.disp, m.buckets * sizeof(std::uint32_t));
+		}
+	}
+};
+
+/**
+ * Write a frozen_map for mapped_map<K, V>.
+ *
+ * \param out The stream to write to, in binary mode
+ * \param m The map to write
+ */
+template <class K, class V>
+void write_mapped(std::ostream& out, const frozen_map<K, V>& m) {
+	mapped_map<K, V>::write(out, m);
+}
+
+/**
+ * Write a static_map for mapped_map<key_type, value_type>.
+ *
+ * The entries are rebuilt into a frozen_map in generator order, so
+ * key_at_index() and at_index() agree with the static_map's, but the
+ * search strategy is chosen again.
+ *
+ * \param out The stream to write to, in binary mode
+ * \param m The map to write
+ */
+template <unsigned N, class KeyGen, class Fn, class Search, class Filter,
+	class Instrument, class Reverse, class Storage>
+void write_mapped(std::ostream& out,
+	const static_map<N, KeyGen, Fn, Search, Filter, Instrument, Reverse, Storage>& m)
+{
+	typedef static_map<N, KeyGen, Fn, Search, Filter, Instrument, Reverse,
+		Storage> map_type;
+	typedef typename map_type::key_type K;
+	typedef typename map_type::value_type V;
+	std::vector<std::pair<K, V>> entries;
+	entries.reserve(N);
+	for (unsigned i = 0; i < N; ++i) {
+		entries.emplace_back(m.key_at_index(i), m.at_index(i));
+	}
+	write_mapped(out, frozen_map<K, V>(entries.begin(), entries.end()));
+}
+
+/**
+ * Write a static_table for mapped_map<unsigned, value_type>.
+ *
+ * The keys are the indices, so lookups compute the index directly.
+ *
+ * \param out The stream to write to, in binary mode
+ * \param t The table to write
+ */
+template <unsigned N, class Fn, class Instrument>
+void write_mapped(std::ostream& out, const static_table<N, Fn, Instrument>& t) {
+	typedef typename static_table<N, Fn, Instrument>::value_type V;
+	std::vector<std::pair<unsigned, V>> entries;
+	entries.reserve(N);
+	for (unsigned i = 0; i < N; ++i) {
+		entries.emplace_back(i, t.at_index(i));
+	}
+	write_mapped(out, frozen_map<unsigned, V>(entries.begin(), entries.end()));
+}
+
+#endif
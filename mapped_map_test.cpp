@@ -0,0 +1,142 @@
+#include "mapped_map.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+constexpr unsigned num = 100;
+
+struct keymap_scrambled {
+    constexpr unsigned operator()(unsigned i) {
+        return (i * 37) % num;
+    }
+};
+
+struct keymap_fractions {
+    constexpr double operator()(unsigned i) {
+        return ((i * 37) % num) / 4.0;
+    }
+};
+
+struct valuemap {
+    constexpr unsigned operator()(unsigned key) {
+        return key*key;
+    }
+};
+
+struct valuemap_fractions {
+    constexpr double operator()(double key) {
+        return key * 2;
+    }
+};
+
+//a hash that ignores the seed cannot be made perfect, so maps of these
+//keys fall back to sorting them
+struct clumped {
+    unsigned k;
+    bool operator==(const clumped& c) const {
+        return k == c.k;
+    }
+    bool operator<(const clumped& c) const {
+        return k < c.k;
+    }
+};
+
+template <>
+struct static_hash<clumped> {
+    constexpr std::uint64_t operator()(clumped, std::uint64_t) const {
+        return 0;
+    }
+};
+
+constexpr static_map<num, keymap_scrambled, valuemap> map_hashed;
+constexpr static_map<num, keymap_fractions, valuemap_fractions> map_sorted;
+constexpr static_table<num, valuemap> table;
+
+//the mapped file answers every lookup the way the original does
+template <class Map, class Mapped>
+bool agrees(const Map& map, const Mapped& mapped, unsigned n) {
+    for (unsigned i = 0; i < n; ++i) {
+        if (mapped[map.key_at_index(i)] != map.at_index(i)
+            || mapped.key_at_index(i) != map.key_at_index(i)
+            || mapped.at_index(i) != map.at_index(i)) {
+            return false;
+        }
+    }
+    return mapped.size() == n;
+}
+
+template <class Map>
+void save(const char* path, const Map& map) {
+    std::ofstream out(path, std::ios::binary);
+    write_mapped(out, map);
+}
+
+int main() {
+    //a mapped file must not change, so each map gets its own
+    save("mapped_map_test_hashed.bin", map_hashed);
+    save("mapped_map_test_sorted.bin", map_sorted);
+    save("mapped_map_test_table.bin", table);
+    const mapped_map<unsigned, unsigned> hashed("mapped_map_test_hashed.bin");
+    const mapped_map<double, double> sorted("mapped_map_test_sorted.bin");
+    mapped_map<unsigned, unsigned> direct("mapped_map_test_table.bin");
+    //the mappings outlive the names
+    std::remove("mapped_map_test_hashed.bin");
+    std::remove("mapped_map_test_sorted.bin");
+    std::remove("mapped_map_test_table.bin");
+
+    std::cout << "Mapped lookups agree: "
+        << (agrees(map_hashed, hashed, num) && agrees(map_sorted, sorted, num)
+            && agrees(table, direct, num)) << '\n';
+    std::cout << "Mapped strategies: " << hashed.hashed() << direct.direct() << '\n';
+    std::cout << "Mapped misses: " << (!hashed.contains(num) && !sorted.contains(18.3)
+        && direct.find(num) == nullptr && direct.get_or(num, 7) == 7) << '\n';
+
+    //a file that is already in memory, aligned for its sections
+    std::ostringstream out;
+    write_mapped(out, map_hashed);
+    const std::string file = out.str();
+    std::vector<std::uint64_t> memory((file.size() + 7) / 8);
+    std::memcpy(memory.data(), file.data(), file.size());
+    const mapped_map<unsigned, unsigned> in_memory(memory.data(), file.size());
+    std::cout << "In memory agrees: " << agrees(map_hashed, in_memory, num) << '\n';
+
+    //the file of a sorted map has no perfect hash section
+    std::vector<std::pair<clumped, unsigned>> clumps;
+    for (unsigned i = 0; i < 8; ++i) {
+        clumps.emplace_back(clumped{ (i * 5) % 8 }, i);
+    }
+    const frozen_map<clumped, unsigned> permuted(clumps.begin(), clumps.end());
+    std::ostringstream permuted_out;
+    write_mapped(permuted_out, permuted);
+    mapped_file_header header;
+    std::memcpy(&header, permuted_out.str().data(), sizeof(header));
+    std::cout << "Permuted file: " << (permuted.permuted() && header.disp_at == 0
+        && header.buckets == 0 && permuted[clumped{ 5 }] == 1) << '\n';
+
+    mapped_map<unsigned, unsigned> moved(std::move(direct));
+    std::cout << "Moved: " << moved[9] << ' ' << direct.size() << '\n';
+
+    try {
+        const mapped_map<unsigned, double> wrong(memory.data(), file.size());
+        std::cout << "Wrong value type accepted\n";
+    }
+    catch (bad_mapped_file& e) {
+        std::cout << "Wrong value type rejected\n";
+    }
+    try {
+        const mapped_map<unsigned, unsigned> truncated(memory.data(), file.size() - 4);
+        std::cout << "Truncated file accepted\n";
+    }
+    catch (bad_mapped_file& e) {
+        std::cout << "Truncated file rejected\n";
+    }
+    try {
+        const mapped_map<unsigned, unsigned> missing("no/such/file");
+    }
+    catch (std::system_error& e) {
+        std::cout << "Missing file: " << e.what() << '\n';
+    }
+    return 0;
+}
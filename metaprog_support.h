@@ -41,7 +41,7 @@ namespace metaprog {
 #else
 
 namespace metaprog {
-	typedef byte unsigned char; //fallback should work most of the time
+	typedef unsigned char byte; //fallback should work most of the time
 	
 	//we can't use the standard library...
 	
@@ -69,9 +69,13 @@ namespace metaprog {
         return (a/b) + (((a % b) != 0) ? 1 : 0);
     }
 
+    //alignas can't be applied to a typedef, so (like
+    //std::aligned_storage) the type is a struct holding the bytes
     template <class T>
     struct aligned_memory {
-        typedef alignas(T) byte[div_roundup(sizeof(T), sizeof(byte))] type;
+        struct type {
+            alignas(T) byte data[div_roundup(sizeof(T), sizeof(byte))];
+        };
     };
     
     template <class T>
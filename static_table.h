@@ -2,8 +2,49 @@
 #define STATIC_TABLE_H_INC
 
 #include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+//define NO_STDLIB for a freestanding build.  Then only the headers
+//above, which freestanding implementations provide, are included, and
+//nothing in this file is initialized at runtime.
+#ifndef NO_STDLIB
 #include <stdexcept>
+#include <iterator>
+#if __cplusplus >= 201703L
+#define STATIC_TABLE_STRING_VIEW
+#include <string_view>
+#endif
+#endif
+
+//without exceptions (-fno-exceptions, or NO_STDLIB), a missing key or a
+//bad generator calls STATIC_TABLE_FAIL(message) instead of throwing.
+//It must not return.  GCC and Clang trap by default; other compilers
+//need it defined.
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS)) && !defined(NO_STDLIB)
+#define STATIC_TABLE_EXCEPTIONS
+#endif
+
+#if !defined(STATIC_TABLE_FAIL) && !defined(STATIC_TABLE_EXCEPTIONS)
+#ifdef __GNUC__
+#define STATIC_TABLE_FAIL(message) ((void)(message), __builtin_trap())
+#else
+#error "static_table.h: define STATIC_TABLE_FAIL(message) to build without exceptions"
+#endif
+#endif
 
+//the batch lookups have SSE2/AVX2 kernels that are picked at runtime.
+//define STATIC_TABLE_NO_SIMD to only build the scalar versions.  The
+//runtime check caches its result in a function-local static, so
+//NO_STDLIB builds only have the scalar versions too.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+	!defined(STATIC_TABLE_NO_SIMD) && !defined(NO_STDLIB)
+#define STATIC_TABLE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#ifndef NO_STDLIB
 /**
  * Exception class that indicates a given value is not in the map
  */
@@ -13,18 +54,462 @@ public:
             "Key not found in static lookup table"
     ) {}
 };
+#else
+/**
+ * Error class that indicates a given value is not in the map
+ *
+ * Without the standard library there is no std::domain_error to derive
+ * from, and nothing is thrown, but the message is the same.
+ */
+class key_not_found_error {
+public:
+    const char* what() const noexcept {
+        return "Key not found in static lookup table";
+    }
+};
+#endif
 
-template <unsigned N, class KeyGen, class Fn>
+/**
+ * Tags that select the lookup strategy used by a static_map.
+ *
+ * The default, static_search::automatic, computes the index directly
+ * if the keys are integers in arithmetic progression, uses a binary
+ * search if the keys are sorted (over an Eytzinger layout once N is
+ * large enough for the keys to fall out of L1), a minimal perfect hash
+ * if they are not sorted but can be hashed with static_hash, a binary
+ * search over keys sorted at compile time if they can be compared with
+ * <, and a linear search otherwise.  The other tags force a particular
+ * strategy, which is a compile-time error if the keys do not support
+ * it.
+ */
+namespace static_search {
+	///pick the best strategy that the keys support
+	struct automatic {};
+	///scan the keys in generator order - O(N)
+	struct linear {};
+	///binary search, requires sorted keys - O(lg(N))
+	struct binary {};
+	///compute the index arithmetically, requires integral or
+	///enumeration keys in arithmetic progression (k = a*i + b) - O(1)
+	struct direct {};
+	///binary search over keys sorted at compile time, requires unique
+	///keys that can be compared with < - O(lg(N))
+	struct sort {};
+	///branchless binary search over keys in Eytzinger (BFS) order,
+	///requires sorted keys - O(lg(N))
+	struct eytzinger {};
+	///minimal perfect hash, requires a static_hash for the keys - O(1)
+	struct perfect_hash {};
+	///piecewise linear model of the key distribution plus a bounded
+	///binary search, requires sorted integral or enumeration keys -
+	///O(1) for near-linear keys, O(lg(N)) in the worst case
+	struct interpolation {};
+	///linear search with the keys in decreasing order of
+	///Profile()(i), the weight of the ith generated key (for example
+	///its hit count; see profile_counter) - O(N), but the hottest keys
+	///are found first
+	template <class Profile>
+	struct profiled {};
+}
+
+/**
+ * Tags that select a filter that static_map consults before searching.
+ *
+ * A filter rejects most keys that are not in the map in a few
+ * instructions, without touching the keys, so a miss costs about as
+ * much as a hit on a small table.  Hits pay for the filter on top of
+ * the search, so a filter only helps when most lookups miss, and only
+ * on searched maps (binary, Eytzinger, sorted or linear).  In
+ * static_table_bench, with 15 in 16 lookups missing a 16384 entry map,
+ * static_filter::bloom<100> cuts an Eytzinger lookup from about 40 ns
+ * to 11 ns, and from about 100 ns to 33 ns at 262144 entries.  Perfectly
+ * hashed and direct maps reject a miss with one read already, and the
+ * filter makes their misses slower: 8 to 12 ns rather than 7.5 to 8 ns
+ * at 16384 entries, and about 25 ns rather than 21 to 24 ns at 262144,
+ * so leave them unfiltered.  Filters need keys that static_hash can
+ * hash.
+ */
+namespace static_filter {
+	///no filter (the default)
+	struct none {};
+	///a Bloom filter that keeps each key's bits in one 64 bit word,
+	///sized so that about 1 in OneIn missing keys gets past it
+	template <unsigned OneIn = 100>
+	struct bloom {};
+}
+
+/**
+ * Tags that select a reverse (value to key) index for static_map.
+ *
+ * The index is built at compile time from the stored values, and
+ * lists the slots of the entries in an order that groups equal values
+ * together, so the keys of a value that several keys map to are found
+ * as one range.  It takes one unsigned per entry, plus one per bucket
+ * when hashed.
+ */
+namespace static_reverse {
+	///no reverse index (the default)
+	struct none {};
+	///entries ordered by value and binary searched, requires values
+	///that can be compared with < - O(lg(N))
+	struct sorted {};
+	///entries grouped into hash buckets by value, requires a
+	///static_hash and == for the values - O(1) expected
+	struct hashed {};
+}
+
+/**
+ * Tags that select how static_map stores its keys and values.
+ *
+ * A hit in a perfectly hashed map reads one key and then its value.
+ * With the keys and the values in separate arrays, those are two cache
+ * misses on a large map.  The other layouts put what a hit reads next
+ * to the key, so they are only available for perfectly hashed maps
+ * (static_search::perfect_hash, or automatic when it picks the hash).
+ * The searches of the other strategies compare many keys per lookup,
+ * and anything stored between the keys would spread them over more
+ * cache lines.  The stored keys and values are not in arrays of their
+ * own, so the other layouts cannot have a static_reverse index or view
+ * them with keys() and values(); the other ordered queries work.
+ */
+namespace static_storage {
+	///keys and values in two arrays (the default)
+	struct separate {};
+	///(key, value) pairs in one array; best for small values
+	struct interleaved {};
+	///(key, hot field) pairs in one array and the whole values in
+	///another.  Hot()(v) is the field of value v that most lookups
+	///read, returned by static_map::hot().
+	template <class Hot>
+	struct hot_cold {};
+}
+
+/**
+ * Tags that select what static_map and static_table record about their
+ * lookups.
+ *
+ * The default, static_instrument::none, records nothing and leaves the
+ * lookups exactly as they are without it.  static_instrument::counted,
+ * which is defined in lookup_stats.h, counts lookups, misses and the
+ * number of probes each lookup took.  Instrumented lookups are not
+ * constant expressions.
+ */
+namespace static_instrument {
+	///record nothing (the default)
+	struct none {
+		///called with the slot each lookup found; returns it unchanged
+		template <class Table, class Map, class K>
+		static constexpr unsigned record(const Map&, const K&, unsigned slot) {
+			return slot;
+		}
+	};
+
+	///count lookups per table and thread (see lookup_stats.h)
+	template <class Name>
+	struct counted;
+}
+
+/**
+ * Tags that select how an interpolated_table evaluates between samples.
+ *
+ * order is the degree of the polynomial between two samples.
+ */
+namespace static_interpolation {
+	///the nearest sample - error O(h)
+	struct nearest {
+		static constexpr unsigned order = 0;
+	};
+	///a straight line between the two neighbouring samples - error O(h^2)
+	struct linear {
+		static constexpr unsigned order = 1;
+	};
+	///a Catmull-Rom spline through the four nearest samples - error O(h^3)
+	struct cubic {
+		static constexpr unsigned order = 3;
+	};
+}
+
+/**
+ * Tags that select how a static_grid stores its cells.
+ */
+namespace static_layout {
+	///the last index varies fastest, as in nested arrays
+	struct row_major {};
+	///row-major blocks of Tile cells per side, themselves in row-major
+	///order, so cells close in every dimension share cache lines
+	template <unsigned Tile = 4>
+	struct tiled {};
+	///Z-order: the bits of the indices are interleaved, so every
+	///aligned power of two block is contiguous
+	struct morton {};
+}
+
+/**
+ * Tags that select how a dispatch_table calls its handlers.
+ */
+namespace static_dispatch {
+	///switched if there are at most dispatch_table::switch_limit
+	///handlers, otherwise table
+	struct automatic {};
+	///an indirect call through the table of function pointers
+	struct table {};
+	///a switch over the index with a direct call in each case, which
+	///the compiler can inline; at most dispatch_table::switch_limit
+	///handlers
+	struct switched {};
+}
+
+/**
+ * A constexpr view of a string, for static_map keys.
+ *
+ * Keys that are pointers to characters compare by address, which is
+ * wrong for text, and std::string cannot be built at compile time.
+ * This is a pointer and a length that compares by content (== and a
+ * lexicographic < on unsigned char), and can be hashed with
+ * static_hash, so a static_map of static_string keys gets a minimal
+ * perfect hash, or sorted keys, like a map of integers.  A KeyGen
+ * returns them from string literals, which live as long as the
+ * program:
+ *
+ * \code{.cpp}
+ *
+ * struct verbs {
+ *     constexpr static_string operator()(unsigned i) {
+ *         return (i == 0) ? "GET" : (i == 1) ? "PUT" : "POST";
+ *     }
+ * };
+ *
+ * \endcode
+ *
+ * Lookups take static_string keys by value, and a static_string can be
+ * made implicitly from a const char* or from anything with data() and
+ * size(), such as std::string or std::string_view, without copying the
+ * characters.  So map["GET"] and map[some_std_string] never allocate.
+ *
+ * Since C++17, std::string_view can be used as the key type directly.
+ */
+class static_string {
+public:
+	///The type of the characters
+	typedef char value_type;
+	///The type of lengths and positions
+	typedef std::size_t size_type;
+	///The string is read-only
+	typedef const char* const_iterator;
+	///The string is read-only
+	typedef const char* iterator;
+
+	///the empty string
+	constexpr static_string() : chars(""), length(0) {}
+
+	///the string s points at, up to its terminating null character
+	constexpr static_string(const char* s) : chars(s), length(measure(s)) {}
+
+	///the n characters starting at s
+	constexpr static_string(const char* s, size_type n) : chars(s), length(n) {}
+
+	///the characters of a string-like object s, such as std::string (s
+	///must outlive this)
+	template <class S, class = typename std::enable_if<
+		std::is_convertible<decltype(std::declval<const S&>().data()), const char*>::value &&
+		!std::is_same<S, static_string>::value>::type,
+		class = decltype(std::declval<const S&>().size())>
+	constexpr static_string(const S& s) : chars(s.data()), length(s.size()) {}
+
+	///the characters (not necessarily followed by a null character)
+	constexpr const char* data() const {
+		return chars;
+	}
+
+	///the number of characters
+	constexpr size_type size() const {
+		return length;
+	}
+
+	///whether there are no characters
+	constexpr bool empty() const {
+		return length == 0;
+	}
+
+	///the ith character (not bounds checked)
+	constexpr char operator[](size_type i) const {
+		return chars[i];
+	}
+
+	constexpr const_iterator begin() const { return chars; }
+	constexpr const_iterator end() const { return chars + length; }
+
+	///compare the characters; strings of different lengths are not equal
+	friend constexpr bool operator==(static_string a, static_string b) {
+		if (a.length != b.length) {
+			return false;
+		}
+		for (size_type i = 0; i < a.length; ++i) {
+			if (a.chars[i] != b.chars[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	///compare the characters as unsigned char, in lexicographic order
+	friend constexpr bool operator<(static_string a, static_string b) {
+		const size_type n = (a.length < b.length) ? a.length : b.length;
+		for (size_type i = 0; i < n; ++i) {
+			const unsigned char x = static_cast<unsigned char>(a.chars[i]);
+			const unsigned char y = static_cast<unsigned char>(b.chars[i]);
+			if (x != y) {
+				return x < y;
+			}
+		}
+		return a.length < b.length;
+	}
+
+	friend constexpr bool operator!=(static_string a, static_string b) { return !(a == b); }
+	friend constexpr bool operator>(static_string a, static_string b) { return b < a; }
+	friend constexpr bool operator<=(static_string a, static_string b) { return !(b < a); }
+	friend constexpr bool operator>=(static_string a, static_string b) { return !(a < b); }
+private:
+	static constexpr size_type measure(const char* s) {
+		size_type n = 0;
+		while (s[n] != '\0') {
+			++n;
+		}
+		return n;
+	}
+
+	const char* chars;
+	size_type length;
+};
+
+/**
+ * A constexpr hash function for static_map keys.
+ *
+ * The primary template is empty, which marks T as not hashable.  It is
+ * specialized for integral and enumeration types, static_string and,
+ * since C++17, std::string_view.  To hash other key
+ * types, specialize this template with a constexpr call operator:
+ *
+ * \code{.cpp}
+ *
+ * template <>
+ * struct static_hash<my_key> {
+ *     constexpr std::uint64_t operator()(my_key k, std::uint64_t seed) const;
+ * };
+ *
+ * \endcode
+ *
+ * Keys that compare equal must hash equal for every seed, and all 64
+ * bits of the result should be well mixed.
+ *
+ * \tparam T The type to hash
+ */
+template <class T, class Enable = void>
+struct static_hash {};
+
+#ifndef DOXYGEN
+template <class T>
+struct static_hash<T, typename std::enable_if<
+	std::is_integral<T>::value || std::is_enum<T>::value
+>::type> {
+	//splitmix64 finalizer
+	constexpr std::uint64_t operator()(T t, std::uint64_t seed) const {
+		std::uint64_t z = static_cast<std::uint64_t>(t) + seed;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+};
+
+template <>
+struct static_hash<static_string> {
+	//8 characters at a time, assembled little-endian so the hash is the
+	//same on every target, then the splitmix64 finalizer over the
+	//length.  The last word overlaps the one before it rather than
+	//being read a character at a time, and shorter strings are read as
+	//two overlapping halves, so every character is read with few
+	//branches.
+	constexpr std::uint64_t operator()(static_string s, std::uint64_t seed) const {
+		const char* p = s.data();
+		const std::size_t n = s.size();
+		std::uint64_t h = seed ^ 0x9e3779b97f4a7c15ULL;
+		if (n >= 8) {
+			for (std::size_t i = 0; i + 8 < n; i += 8) {
+				h = (h ^ word(p + i)) * 0xff51afd7ed558ccdULL;
+				h ^= h >> 32;
+			}
+			h ^= word(p + n - 8);
+		}
+		else if (n >= 4) {
+			h ^= half(p) | half(p + n - 4) << 32;
+		}
+		else if (n > 0) {
+			h ^= byte(p[0]) | byte(p[n / 2]) << 8 | byte(p[n - 1]) << 16;
+		}
+		return static_hash<std::uint64_t>{}((h * 0xc4ceb9fe1a85ec53ULL) ^ n, seed);
+	}
+
+	static constexpr std::uint64_t byte(char c) {
+		return static_cast<unsigned char>(c);
+	}
+
+	//written out, from a pointer to the first character, so that
+	//compilers merge them into one load
+	static constexpr std::uint64_t half(const char* p) {
+		return byte(p[0]) | byte(p[1]) << 8 | byte(p[2]) << 16 | byte(p[3]) << 24;
+	}
+
+	static constexpr std::uint64_t word(const char* p) {
+		return byte(p[0]) | byte(p[1]) << 8 | byte(p[2]) << 16 | byte(p[3]) << 24 |
+			byte(p[4]) << 32 | byte(p[5]) << 40 | byte(p[6]) << 48 | byte(p[7]) << 56;
+	}
+};
+
+#ifdef STATIC_TABLE_STRING_VIEW
+template <>
+struct static_hash<std::string_view> {
+	constexpr std::uint64_t operator()(std::string_view s, std::uint64_t seed) const {
+		return static_hash<static_string>{}(static_string(s.data(), s.size()), seed);
+	}
+};
+#endif
+#endif
+
+template <unsigned N, class KeyGen, class Fn, class Search, class Filter,
+	class Instrument, class Reverse, class Storage>
 class static_map;
 
-template <unsigned N, class Fn>
+template <class Map>
+class profile_counter;
+
+template <unsigned N, class Fn, class Instrument>
 class static_table;
 
+template <unsigned N, class Fn>
+class packed_static_table;
+
+template <unsigned N, class KeyGen, class Fn>
+class sparse_static_map;
+
+template <unsigned N, class Fn, class Domain, class Mode>
+class interpolated_table;
+
+template <class Fn, class Layout, unsigned... Dims>
+class static_grid;
+
+template <unsigned N, template <unsigned> class Handler, class Mode>
+class dispatch_table;
+
+template <class K, class V>
+class frozen_map;
+
 /**
  * Implementation container for static_map, static_table
  * 
  * This class holds components of static_table that are not dependent
- * On some or all of static_table's template parameters.
+ * On some or all of static_table's template parameters.  The lookup
+ * and build algorithms that do not need a compile-time size are also
+ * used by frozen_map (see frozen_map.h).
  *
  * They are moved into a separate class to avoid excess code generation.
  * 
@@ -34,10 +519,27 @@ class static_table;
  */
 class static_table_impl {
 	//make static_map, static_table friends so it can use our private members
-    template <unsigned N, class KeyGen, class Fn>
+    template <unsigned N, class KeyGen, class Fn, class Search, class Filter,
+		class Instrument, class Reverse, class Storage>
     friend class static_map;
-    template <unsigned N, class Fn>
+    template <unsigned N, class Fn, class Instrument>
     friend class static_table;
+    template <class Name>
+    friend struct static_instrument::counted;
+    template <class Map>
+    friend class profile_counter;
+    template <unsigned N, class Fn>
+    friend class packed_static_table;
+    template <unsigned N, class KeyGen, class Fn>
+    friend class sparse_static_map;
+    template <unsigned N, class Fn, class Domain, class Mode>
+    friend class interpolated_table;
+    template <class Fn, class Layout, unsigned... Dims>
+    friend class static_grid;
+    template <unsigned N, template <unsigned> class Handler, class Mode>
+    friend class dispatch_table;
+    template <class K, class V>
+    friend class frozen_map;
 private:
     /**
      * A compile-time sequence of unsigned integers.
@@ -52,19 +554,78 @@ private:
 	 * 
 	 * gen_seq<N> will be a subclass of seq<0, ... N>
 	 * 
+	 * The sequence is built by joining two sequences of half the
+	 * length, so the recursion depth is lg(N).
+	 * 
 	 * \tparam N The upper bound on the sequence
 	 */
 	template <unsigned N>
 	struct gen_seq<N> {};
 	#else
 	//real code for this:
-    template <unsigned N, unsigned... Is>
-    struct gen_seq : gen_seq<N-1, N-1, Is...> {};
+	template <class A, class B>
+	struct join_seq;
 
-    template <unsigned... Is>
-    struct gen_seq<0, Is...> : seq<Is...> {};
+	template <unsigned... As, unsigned... Bs>
+	struct join_seq<seq<As...>, seq<Bs...>> {
+		typedef seq<As..., (sizeof...(As) + Bs)...> type;
+	};
+
+    //the unused second parameter lets the base cases be partial
+    //specializations, which are allowed at class scope
+    template <unsigned N, class = void>
+    struct gen_seq : join_seq<
+		typename gen_seq<N/2>::type,
+		typename gen_seq<N - N/2>::type
+	>::type {
+		typedef typename join_seq<
+			typename gen_seq<N/2>::type,
+			typename gen_seq<N - N/2>::type
+		>::type type;
+	};
+
+    template <class D>
+    struct gen_seq<0, D> : seq<> {
+		typedef seq<> type;
+	};
+
+    template <class D>
+    struct gen_seq<1, D> : seq<0> {
+		typedef seq<0> type;
+	};
     #endif
 
+	/**
+	 * Whether a storage type for K and V can be filled in a loop.
+	 *
+	 * Filling arrays in a constexpr loop scales to millions of entries,
+	 * but the arrays must be value-initialized first, which needs
+	 * trivially default constructible types.  Other types are generated
+	 * with one big pack expansion instead.
+	 */
+	template <class K, class V>
+	struct loop_buildable : std::integral_constant<bool,
+		std::is_trivially_default_constructible<K>::value &&
+		std::is_trivially_default_constructible<V>::value
+	> {};
+
+	/**
+	 * Generate the keys and values of a storage type in a loop.
+	 *
+	 * \param r The storage to fill; it must have keys and values arrays
+	 * \param order order[s] is the generator index for slot s, or null
+	 * for the identity
+	 * \param keygen The key generator
+	 * \param func The value generator
+	 */
+	template <class Map, class KeyGen, class Fn>
+	static constexpr void fill(Map& r, const unsigned* order, KeyGen keygen, Fn func) {
+		for (unsigned s = 0; s < Map::length; ++s) {
+			r.keys[s] = keygen(order ? order[s] : s);
+			r.values[s] = func(r.keys[s]);
+		}
+	}
+
 	/**
 	 * A type-traits class that detects if T can be compared with <
 	 * 
@@ -113,6 +674,27 @@ private:
 		static constexpr bool value = (sizeof(test(0)) == sizeof(a));
 	};
     
+	/**
+	 * A type-traits class that detects if static_hash<T> is usable
+	 *
+	 * \tparam T The type to check
+	 */
+	#ifdef DOXYGEN
+	template <class T>
+	struct hashable {
+		///Whether static_hash<T> has a suitable call operator
+		static constexpr bool value;
+	};
+	#else
+	template <class T, class = void>
+	struct hashable : std::false_type {};
+
+	template <class T>
+	struct hashable<T, decltype(void(
+		static_hash<T>{}(std::declval<T>(), std::uint64_t{})
+	))> : std::true_type {};
+	#endif
+
     /** 
      * A constexpr function that gets the midpoint of a range
      * 
@@ -123,462 +705,5603 @@ private:
     static constexpr unsigned midpoint(unsigned begin, unsigned end) {
 		return begin + ((end - begin) / 2);
 	}
-};
 
-/**
- * A statically initialized lookup map.
- * 
- * The KeyGen type must be able to map an unsigned index in the range
- * [0, N) to a key.  The Fn type then maps the output of the KeyGen type
- * to values.  Values can be looked up by key or by index.
- * 
- * Calling an object of type KeyGen or Fn MUST be a constexpr operation.
- * To use the default constructor, KeyGen and Fn MUST be constexpr
- * default constructable function objects.  
- * 
- * To use regular functions, see the global function generate_static_map().
- * 
- * To illustrate:
- * 
- * \code{.cpp}
- * 
- * //An example of types that would be valid:
- * template <typename key_type, typename value_type>
- * struct static_map_functs {
- *     struct KeyGen {
- *         constexpr key_type operator()(unsigned);
- *     };
- *     struct Fn {
- *         constexpr value_type operator()(key_type);
- *     };
- * };
- * 
- * \endcode
- * 
- * If an object of type KeyGen k maps [0, N) in a manner such that
- * k(x) < k(x+1) for all x in [0, N-1), then this class can perform
- * some optimizations in the lookup phase.  If key_type cannot be
- * compared using <, or if the result of such a comparison is not
- * convertible to bool, then this check will be skipped.
- * 
- * \tparam N The number of entries in the lookup table
- * \tparam KeyGen A type that maps a sequence to a series of keys
- * \tparam Fn A type that maps a key to a value
- */
-template <unsigned N, class KeyGen, class Fn>
-class static_map {
-public:
-    //public typedefs
-    ///The type of the keys in the map
-    typedef decltype((KeyGen{})(0U)) key_type;
-    ///The type of the mapped values in the map
-    //can't assume that key_type is default constructible
-    typedef decltype((Fn{})((KeyGen{})(0U))) value_type;
-    ///Shorthand form for the type of this object
-    typedef static_map<N, KeyGen, Fn> this_type;
-    ///The number of (key, value) pairs in the map
-    static constexpr unsigned length = N;
-private:
+	/**
+	 * A bijective 32 bit integer mixing function.
+	 *
+	 * \param x The value to mix
+	 * \return The mixed value
+	 */
+	static constexpr std::uint32_t mix32(std::uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7feb352dU;
+		x ^= x >> 15;
+		x *= 0x846ca68bU;
+		return x ^ (x >> 16);
+	}
 
-	//decrease verbosity
-	typedef static_table_impl impl;
+	/**
+	 * The inverse of mix32().
+	 *
+	 * \param x The mixed value
+	 * \return The value y such that mix32(y) == x
+	 */
+	static constexpr std::uint32_t unmix32(std::uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x43021123U;
+		x ^= (x >> 15) ^ (x >> 30);
+		x *= 0x1d69e2a5U;
+		return x ^ (x >> 16);
+	}
 
-    /**
-     * A struct to hold all of the data.
-     * 
-     * This needs to be aggregate constructable so that the outer class'
-     * constructor will work and so that we can do everything with the
-     * variadic template.  It also defines its own member functions for
-     * looking up values to simplify static_map's  implementation.
-     * 
-     * Though it might be theoretically possible to implement this as
-     * a hash table, it would add a significant degree of complexity
-     * for the gain of O(1) performance.  Additionally, if performance
-     * is critical then users should make pains to ensure that the
-     * keys are sorted.  In such a circumstance, N must be very large
-     * in order for the overhead of hashing to be faster than a normal
-     * binary search.
-     * 
-     * Long story short - I judged that hashing wasn't worth it.  With
-     * constexpr and TMP it's already complex enough!
-     * 
-     * \tparam Sorted If key[i] < key[i+1] for all i | 0 < i < N
-     */
-    template <bool Sorted>
-    struct map_t {
-		///the array of keys
-        key_type keys[N];
-        ///the array of values such that keys[i] maps to values[i]
-        value_type values[N];
-        
-        ///also can have length here for convenience's sake
-        static constexpr unsigned length = N;
-        ///so it's easier to refer to sorted outside the template
-        static constexpr unsigned sorted = Sorted;
-		
-		#ifdef DOXYGEN
-		/**
-		 * Get the index of key in keys.
-		 * 
-		 * If sorted is true, this performs a binary search of keys for
-		 * key.  This should be O(lg(N)) in the worst case.
-		 * 
-		 * If sorted is false, this performs a linear search of keys
-		 * for key.  This should be O(N) in the worst case.
-		 * 
-		 * \param key The key to search for in keys
-		 * \return The index of key in keys (i.e., keys[i] == key)
-		 * 
-		 * \throws key_not_found_error key is not in this map.
-		 */
-		constexpr unsigned index_of(key_type key);
+	/**
+	 * The slot of a key in a perfect hash table.
+	 *
+	 * The displacement is applied before mixing so that it changes
+	 * every bit that the modulus looks at, even if N is a power of two.
+	 *
+	 * \param h The key's static_hash
+	 * \param disp The displacement of the key's bucket
+	 * \return The slot, in [0, N)
+	 */
+	template <unsigned N>
+	static constexpr unsigned phf_slot(std::uint64_t h, std::uint32_t disp) {
+		return phf_slot(h, disp, N);
+	}
+
+	///phf_slot() for a table of n slots
+	static constexpr unsigned phf_slot(std::uint64_t h, std::uint32_t disp, unsigned n) {
+		return mix32(static_cast<std::uint32_t>(h) ^ disp) % n;
+	}
+	/**
+	 * Report a key that is not in a table.
+	 *
+	 * Without exceptions this calls STATIC_TABLE_FAIL.  It is not
+	 * constexpr, so a miss in a constant expression is a compile error
+	 * either way.
+	 *
+	 * \throws key_not_found_error always
+	 */
+	[[noreturn]] static void key_not_found() {
+		#ifdef STATIC_TABLE_EXCEPTIONS
+		throw key_not_found_error{};
 		#else
-		//for the next two functions:
-		
-		//the b template argument is needed to make the enable_if depend
-		//on a deduced parameter so SFINAE works
-		
-		//the T argument is to make it so the function signatures do not
-		//conflict and SFINAE will eliminate one version silently
-		
-        //find the index of key IF sorted (binary search)
-        template <bool b = Sorted, class T = this_type>
-        constexpr typename std::enable_if<b, unsigned>::type
-        index_of(typename T::key_type key, unsigned begin = 0, unsigned end = N)
-        {
-            //partition at the midpoint
-            return 
-            //if this is a real range
-            (begin < end) ? 
-                //if the partition is the key
-                ((keys[impl::midpoint(begin, end)] == key) ? 
-                    //return the partition index    
-                    impl::midpoint(begin, end) 
-                //else
-                : 
-                    //if the partition is less than the key
-                    ((keys[impl::midpoint(begin, end)] < key) ?
-                        //then search range after the partition for the key  
-                        index_of(key, impl::midpoint(begin, end)+1, end)
-                    //else
-                    :
-                        //search the range before the partition for the key
-                        index_of(key, begin, impl::midpoint(begin, end))
-                    )
-                ) 
-            //else, throw an error, as the key is not in the set
-            : throw key_not_found_error{};
-        }
-        
-        //find the index of key IF unsorted (linear search)
-        template <bool b = Sorted, class T = this_type>
-        constexpr typename std::enable_if<!b, unsigned>::type 
-        index_of(typename T::key_type key, unsigned begin = 0, unsigned end = N)
-        {
-            return
-            //if this is a real range
-            (begin < end) ?
-                //if the key is at the front of the range
-                ((keys[begin] == key) ?
-                    //return the front
-                    begin
-                //else
-                : 
-                    //look for key in the tail
-                    index_of(key, begin+1, end)
-                )
-            //else, throw an error, as key is not in the set
-            : throw key_not_found_error{};
-        }
-        #endif
-        
-        /**
-         * Look up key
-         * 
-         * Find the value that key maps to in the tables.
-         * 
-         * \param key The key to map
-         * \return The mapped value for key
-         * \throws key_not_found_error key is not in this map
-         */
-        constexpr value_type operator[](key_type key) {
-            //look up the key, get its index, return corresponding value
-            return values[index_of(key)];
-        }
-    };
+		STATIC_TABLE_FAIL("Key not found in static lookup table");
+		#endif
+	}
 
-	//don't document this section
-	#ifndef DOXYGEN
-	
-    //how to determine if the keys are sorted, and thus if the table
-    //can use binary search or must do a linear search
-    //
-    //For SFINAE the T must be key_type.  We can't default it
-    //due to variadic template arguments :(
-    
-    //base case:
-    template <class T, unsigned I1, unsigned I2, unsigned... Is>
-    static constexpr typename
-    std::enable_if<impl::comparable<T>::value, bool>::type
-    keys_sorted(KeyGen keygen) {
-		//check if the front two are out of order.  If they are, we
-		//aren't sorted.  If they aren't, check the next two.
-        return (keygen(I2) < keygen(I1)) ?
-            false :
-            keys_sorted<T, I2, Is...>(keygen);
+	/**
+	 * Report keys that a table cannot be built from (see key_not_found()).
+	 *
+	 * \param message What is wrong with the keys
+	 *
+	 * \throws std::invalid_argument always
+	 */
+	[[noreturn]] static void bad_keys(const char* message) {
+		#ifdef STATIC_TABLE_EXCEPTIONS
+		throw std::invalid_argument(message);
+		#else
+		STATIC_TABLE_FAIL(message);
+		#endif
+	}
+
+	/**
+	 * Check the result of a storage type's find().
+	 *
+	 * \param i The index returned by find()
+	 * \return i
+	 *
+	 * \throws key_not_found_error i is N, meaning the key was not found
+	 */
+	template <unsigned N>
+	static constexpr unsigned checked_index(unsigned i) {
+		return (i != N) ? i : (key_not_found(), N);
+	}
+
+	/**
+	 * Hint that the cache line holding p will be read soon.
+	 *
+	 * This is a no-op during constant evaluation.
+	 *
+	 * \param p The address to prefetch
+	 */
+	static constexpr void prefetch(const void* p) {
+		#if defined(__GNUC__)
+		if (!__builtin_is_constant_evaluated()) {
+			__builtin_prefetch(p);
+		}
+		#else
+		(void)p;
+		#endif
+	}
+
+	/**
+	 * Undo the descent of an Eytzinger search past its lower bound.
+	 *
+	 * The descent turns right (appends a 1 bit) while the keys are less
+	 * than the search key, and the lower bound is the node of its last
+	 * left turn, so this drops the trailing 1 bits and the 0 above them.
+	 *
+	 * \param k The node the descent ended at
+	 * \return The node of the last left turn, or 0 if there was none
+	 */
+	static constexpr unsigned last_left_turn(unsigned k) {
+		#if defined(__GNUC__)
+		return k >> __builtin_ffs(~k);
+		#else
+		while (k & 1) {
+			k >>= 1;
+		}
+		return k >> 1;
+		#endif
+	}
+
+	/**
+	 * Storage for a linearly searched map.
+	 *
+	 * This needs to be aggregate constructable so that types which
+	 * cannot be filled in a loop can be generated with the variadic
+	 * template.  It also defines its own member functions for looking
+	 * up values to simplify static_map's implementation.
+	 *
+	 * Keys are stored in generator order, so the index of a key is its
+	 * generator index.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct linear_map {
+		///the array of keys
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr linear_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(), keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr linear_map build(std::true_type, KeyGen keygen, Fn func) {
+			linear_map r{};
+			fill(r, nullptr, keygen, func);
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr linear_map build(std::false_type, KeyGen keygen, Fn func) {
+			return build(gen_seq<N>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is>
+		static constexpr linear_map build(seq<Is...>, KeyGen keygen, Fn func) {
+			return { { keygen(Is)... }, { func(keygen(Is))... } };
+		}
+		#endif
+
+		/**
+		 * Find the index of key in keys.
+		 *
+		 * This performs a linear search of keys for key.  This should
+		 * be O(N) in the worst case.
+		 *
+		 * \param key The key to search for in keys
+		 * \return The index of key in keys (i.e., keys[i] == key), or N
+		 * if key is not in this map
+		 */
+		constexpr unsigned find(K key) const {
+			for (unsigned i = 0; i < N; ++i) {
+				if (keys[i] == key) {
+					return i;
+				}
+			}
+			//key is not in the set
+			return N;
+		}
+
+		/**
+		 * Get the index of key in keys.
+		 *
+		 * \param key The key to search for in keys
+		 * \return The index of key in keys (i.e., keys[i] == key)
+		 *
+		 * \throws key_not_found_error key is not in this map.
+		 */
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return i;
+		}
+
+		/**
+		 * Look up key
+		 *
+		 * \param key The key to map
+		 * \return The mapped value for key
+		 * \throws key_not_found_error key is not in this map
+		 */
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	/**
+	 * Find the lower bound of a key in sorted keys.
+	 *
+	 * \param keys The sorted keys
+	 * \param key The key to search for
+	 * \param n The number of keys
+	 * \return The index of the first key that is not less than key, or
+	 * n if there is none
+	 */
+	template <class K>
+	static constexpr unsigned binary_lower(const K* keys, K key, unsigned n) {
+		unsigned begin = 0;
+		unsigned end = n;
+		//while this is a real range
+		while (begin < end) {
+			//partition at the midpoint
+			const unsigned mid = midpoint(begin, end);
+			//search the half that can hold the bound
+			if (keys[mid] < key) {
+				begin = mid + 1;
+			}
+			else {
+				end = mid;
+			}
+		}
+		return begin;
+	}
+
+	/**
+	 * Binary search sorted keys.
+	 *
+	 * \param keys The N sorted keys
+	 * \param key The key to search for
+	 * \param N The number of keys
+	 * \return The index of key in keys (i.e., keys[i] == key), or N
+	 * if key is not in keys
+	 */
+	template <class K>
+	static constexpr unsigned binary_find(const K* keys, K key, unsigned N) {
+		unsigned begin = 0;
+		unsigned end = N;
+		//while this is a real range
+		while (begin < end) {
+			//partition at the midpoint
+			const unsigned mid = midpoint(begin, end);
+			if (keys[mid] == key) {
+				return mid;
+			}
+			//search the half that can hold the key
+			if (keys[mid] < key) {
+				begin = mid + 1;
+			}
+			else {
+				end = mid;
+			}
+		}
+		//the key is not in the set
+		return N;
+	}
+
+	/**
+	 * Storage for a map with sorted keys.
+	 *
+	 * The layout is the same as linear_map, but find() performs a
+	 * binary search.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct sorted_map {
+		///the array of keys
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr sorted_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(), keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr sorted_map build(std::true_type, KeyGen keygen, Fn func) {
+			sorted_map r{};
+			fill(r, nullptr, keygen, func);
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr sorted_map build(std::false_type, KeyGen keygen, Fn func) {
+			return build(gen_seq<N>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is>
+		static constexpr sorted_map build(seq<Is...>, KeyGen keygen, Fn func) {
+			return { { keygen(Is)... }, { func(keygen(Is))... } };
+		}
+		#endif
+
+		/**
+		 * Find the index of key in keys.
+		 *
+		 * This performs a binary search of keys for key.  This should
+		 * be O(lg(N)) in the worst case.
+		 *
+		 * \param key The key to search for in keys
+		 * \return The index of key in keys (i.e., keys[i] == key), or N
+		 * if key is not in this map
+		 */
+		constexpr unsigned find(K key) const {
+			return binary_find(keys, key, N);
+		}
+
+		///get the index of key in keys (see linear_map::index_of())
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return i;
+		}
+
+		///look up key (see linear_map::operator[]())
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	/**
+	 * A permutation between generator order and storage order.
+	 *
+	 * \tparam N The number of entries
+	 */
+	template <unsigned N>
+	struct permutation {
+		///order[s] is the generator index of the entry stored in slot s
+		unsigned order[N];
+		///slot_of[i] is the slot where generator index i is stored
+		unsigned slot_of[N];
+	};
+
+	/**
+	 * Lay out sorted indices in Eytzinger (BFS) order.
+	 *
+	 * Slot s (0-based) holds the node numbered s+1 in a 1-based implicit
+	 * binary tree whose children of node k are 2k and 2k+1.  An in-order
+	 * walk of that tree visits the generator indices in order.
+	 *
+	 * The walk is a loop rather than a recursion: it steps from each
+	 * node to its in-order successor.
+	 *
+	 * \return The permutation from generator order to Eytzinger order
+	 */
+	template <unsigned N>
+	static constexpr permutation<N> eytzinger_build() {
+		permutation<N> r{};
+		//order is filled out of sequence below.  Storing each element in
+		//sequence first keeps those stores cheap for the compiler, which
+		//otherwise has to insert into a sparse array.
+		for (unsigned s = 0; s < N; ++s) {
+			r.order[s] = 0;
+		}
+		//start at the leftmost node
+		unsigned k = 1;
+		while (2*k <= N) {
+			k = 2*k;
+		}
+		for (unsigned next = 0; next < N; ++next) {
+			r.order[k - 1] = next;
+			r.slot_of[next] = k - 1;
+			if (2*k + 1 <= N) {
+				//the successor is the leftmost node of the right subtree
+				k = 2*k + 1;
+				while (2*k <= N) {
+					k = 2*k;
+				}
+			}
+			else {
+				//climb out of right subtrees, then up once more
+				while (k & 1) {
+					k >>= 1;
+				}
+				k >>= 1;
+			}
+		}
+		return r;
+	}
+
+	/**
+	 * Sort the keys produced by keygen.
+	 *
+	 * This is a bottom-up merge sort of the generator indices, so it
+	 * takes O(N lg(N)) comparisons and no recursion.  It is stable, so
+	 * equal keys stay in generator order.
+	 *
+	 * \param keygen The key generator
+	 * \return The permutation from generator order to sorted order
+	 */
+	template <unsigned N, class KeyGen>
+	static constexpr permutation<N> sort_build(KeyGen keygen) {
+		permutation<N> r{};
+		unsigned buf[N] = {};
+		for (unsigned s = 0; s < N; ++s) {
+			r.order[s] = s;
+		}
+		for (unsigned width = 1; width < N; width *= 2) {
+			//merge the runs [lo, mid) and [mid, hi) of r.order into buf
+			for (unsigned lo = 0; lo < N; lo += 2*width) {
+				const unsigned mid = (N - lo > width) ? lo + width : N;
+				const unsigned hi = (N - mid > width) ? mid + width : N;
+				unsigned a = lo;
+				unsigned b = mid;
+				for (unsigned s = lo; s < hi; ++s) {
+					//take from the right run only if it is strictly less
+					buf[s] = (a < mid && (b == hi ||
+						!(keygen(r.order[b]) < keygen(r.order[a])))) ?
+						r.order[a++] : r.order[b++];
+				}
+			}
+			for (unsigned s = 0; s < N; ++s) {
+				r.order[s] = buf[s];
+			}
+		}
+		for (unsigned s = 0; s < N; ++s) {
+			r.slot_of[r.order[s]] = s;
+		}
+		return r;
+	}
+
+	/**
+	 * Whether sort_build gives strictly increasing keys for KeyGen.
+	 *
+	 * That is false if and only if some keys are equivalent.  This is
+	 * only evaluated if Try is true (see phf_ok()).
+	 */
+	template <bool Try, unsigned N, class KeyGen>
+	static constexpr typename std::enable_if<Try, bool>::type sort_ok() {
+		KeyGen keygen{};
+		const permutation<N> p = sort_build<N>(keygen);
+		for (unsigned s = 1; s < N; ++s) {
+			if (!(keygen(p.order[s - 1]) < keygen(p.order[s]))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	#ifndef DOXYGEN
+	template <bool Try, unsigned N, class KeyGen>
+	static constexpr typename std::enable_if<!Try, bool>::type sort_ok() {
+		return false;
+	}
+	#endif
+
+	/**
+	 * Storage for a map whose keys were sorted at compile time.
+	 *
+	 * The keys are stored in sorted order and binary searched as in
+	 * sorted_map.  slot_of maps generator indices to slots so that
+	 * at_index() and key_at_index() still use generator order.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct permuted_map {
+		///the array of keys, in sorted order
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+		///slot_of[i] is the slot of the ith generated entry
+		unsigned slot_of[N];
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr permuted_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(), sort_build<N>(keygen), keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr permuted_map build(std::true_type,
+			const permutation<N>& p, KeyGen keygen, Fn func)
+		{
+			permuted_map r{};
+			fill(r, p.order, keygen, func);
+			for (unsigned i = 0; i < N; ++i) {
+				r.slot_of[i] = p.slot_of[i];
+			}
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr permuted_map build(std::false_type,
+			const permutation<N>& p, KeyGen keygen, Fn func)
+		{
+			return build(p, gen_seq<N>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is>
+		static constexpr permuted_map build(const permutation<N>& p,
+			seq<Is...>, KeyGen keygen, Fn func)
+		{
+			return {
+				{ keygen(p.order[Is])... },
+				{ func(keygen(p.order[Is]))... },
+				{ p.slot_of[Is]... }
+			};
+		}
+		#endif
+
+		///find the slot of key in keys (see sorted_map::find())
+		constexpr unsigned find(K key) const {
+			return binary_find(keys, key, N);
+		}
+
+		///get the index of key in keys (see linear_map::index_of())
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return slot_of[i];
+		}
+
+		///look up key (see linear_map::operator[]())
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	/**
+	 * Order generator indices by decreasing weight for sort_build().
+	 *
+	 * sort_build() sorts by <, so the weights are wrapped in a type
+	 * whose < is reversed.  The sort is stable, so keys of equal weight
+	 * stay in generator order.
+	 *
+	 * \tparam Profile Maps a generator index to a weight
+	 */
+	template <class Profile>
+	struct profile_order {
+		///a weight that compares in reverse
+		struct hotness {
+			decltype((Profile{})(0U)) weight;
+
+			constexpr bool operator<(const hotness& h) const {
+				return h.weight < weight;
+			}
+		};
+
+		Profile profile;
+
+		constexpr hotness operator()(unsigned i) {
+			return { profile(i) };
+		}
+	};
+
+	/**
+	 * Storage for a map that is searched linearly in profile order.
+	 *
+	 * This is linear_map with the entries stored hottest first (see
+	 * static_search::profiled), so a skewed workload finds most keys
+	 * in the first few probes.  slot_of maps generator indices to slots
+	 * so that at_index() and key_at_index() still use generator order.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 * \tparam Profile Maps a generator index to a weight
+	 */
+	template <unsigned N, class K, class V, class Profile>
+	struct profiled_map {
+		///the array of keys, hottest first
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+		///slot_of[i] is the slot of the ith generated entry
+		unsigned slot_of[N];
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr profiled_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(),
+				sort_build<N>(profile_order<Profile>{}), keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr profiled_map build(std::true_type,
+			const permutation<N>& p, KeyGen keygen, Fn func)
+		{
+			profiled_map r{};
+			fill(r, p.order, keygen, func);
+			for (unsigned i = 0; i < N; ++i) {
+				r.slot_of[i] = p.slot_of[i];
+			}
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr profiled_map build(std::false_type,
+			const permutation<N>& p, KeyGen keygen, Fn func)
+		{
+			return build(p, gen_seq<N>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is>
+		static constexpr profiled_map build(const permutation<N>& p,
+			seq<Is...>, KeyGen keygen, Fn func)
+		{
+			return {
+				{ keygen(p.order[Is])... },
+				{ func(keygen(p.order[Is]))... },
+				{ p.slot_of[Is]... }
+			};
+		}
+		#endif
+
+		///find the slot of key in keys (see linear_map::find())
+		constexpr unsigned find(K key) const {
+			for (unsigned i = 0; i < N; ++i) {
+				if (keys[i] == key) {
+					return i;
+				}
+			}
+			return N;
+		}
+
+		///get the index of key in keys (see linear_map::index_of())
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return slot_of[i];
+		}
+
+		///look up key (see linear_map::operator[]())
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	/**
+	 * Rotate a 64 bit integer right.
+	 *
+	 * \param x The value to rotate
+	 * \param r The distance, in [0, 64)
+	 * \return x rotated right by r bits
+	 */
+	static constexpr std::uint64_t rotr64(std::uint64_t x, unsigned r) {
+		//(x << 1) << (63 - r) is x << (64 - r) without shifting by 64
+		return (x >> r) | ((x << 1) << (63 - r));
+	}
+
+	/**
+	 * The result of checking if keys are in arithmetic progression.
+	 *
+	 * Keys are converted to 64 bit unsigned integers, where key i is
+	 * origin + i*stride (mod 2^64).  The stride is odd * 2^shift, and
+	 * inverse is the inverse of odd mod 2^64.
+	 */
+	struct affine_layout {
+		///whether the keys are in arithmetic progression
+		bool ok;
+		///the first key
+		std::uint64_t origin;
+		///the inverse of the odd part of the stride
+		std::uint64_t inverse;
+		///the number of trailing zeros of the stride
+		unsigned shift;
+	};
+
+	/**
+	 * Find the generator index of a key in arithmetic progression.
+	 *
+	 * This is exact division by the stride: the difference from the
+	 * first key is multiplied by the inverse of the stride's odd part
+	 * and rotated right by its trailing zeros.  If the difference is
+	 * not a multiple of the stride, the bits that should be zero are
+	 * rotated to the top, so the result is out of range.  Since the
+	 * conversion of keys to 64 bits is one-to-one, a result below N is
+	 * the index of a key equal to key.
+	 *
+	 * \param l The progression
+	 * \param key The key, converted to a 64 bit unsigned integer
+	 * \return The generator index of key, or something >= N if key is
+	 * not in the progression
+	 */
+	static constexpr std::uint64_t affine_index(const affine_layout& l, std::uint64_t key) {
+		return rotr64((key - l.origin) * l.inverse, l.shift);
+	}
+
+	/**
+	 * Check if the keys produced by keygen are in arithmetic progression.
+	 *
+	 * The stride may be negative (it wraps mod 2^64), but not zero, and
+	 * the first N multiples of it must be distinct mod 2^64.
+	 *
+	 * \param keygen The key generator
+	 * \param N The number of keys
+	 * \return The progression, with ok == false if there is none
+	 */
+	template <class K, class KeyGen>
+	static constexpr affine_layout affine_build(KeyGen keygen, unsigned N) {
+		affine_layout r{};
+		r.origin = static_cast<std::uint64_t>(keygen(0));
+		const std::uint64_t stride = (N > 1) ?
+			static_cast<std::uint64_t>(keygen(1)) - r.origin : 1;
+		if (stride == 0) {
+			return r;
+		}
+		std::uint64_t odd = stride;
+		while (!(odd & 1)) {
+			odd >>= 1;
+			++r.shift;
+		}
+		if (r.shift != 0 && ((N - 1ULL) >> (64 - r.shift)) != 0) {
+			return r;
+		}
+		//Newton's method doubles the correct low bits every step, and
+		//odd is its own inverse mod 8
+		r.inverse = odd;
+		for (unsigned i = 0; i < 5; ++i) {
+			r.inverse *= 2 - odd * r.inverse;
+		}
+		for (unsigned i = 1; i < N; ++i) {
+			if (static_cast<std::uint64_t>(keygen(i)) - static_cast<std::uint64_t>(keygen(i - 1)) != stride) {
+				return r;
+			}
+		}
+		r.ok = true;
+		return r;
+	}
+
+	/**
+	 * Whether the keys produced by KeyGen are in arithmetic progression.
+	 *
+	 * This is only evaluated if Try is true (see phf_ok()).
+	 */
+	template <bool Try, unsigned N, class K, class KeyGen>
+	static constexpr typename std::enable_if<Try, bool>::type affine_ok() {
+		return affine_build<K>(KeyGen(), N).ok;
+	}
+
+	#ifndef DOXYGEN
+	template <bool Try, unsigned N, class K, class KeyGen>
+	static constexpr typename std::enable_if<!Try, bool>::type affine_ok() {
+		return false;
+	}
+	#endif
+
+	/**
+	 * Storage for a map whose keys are in arithmetic progression.
+	 *
+	 * Keys and values are stored in generator order.  find() computes
+	 * the index with one subtraction, one multiplication and one
+	 * rotation, and never reads keys, so a lookup costs about the same
+	 * as a static_table lookup.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct affine_map {
+		///the array of keys
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+		///the progression of the keys
+		affine_layout layout;
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr affine_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(), affine_build<K>(keygen, N),
+				keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr affine_map build(std::true_type,
+			const affine_layout& l, KeyGen keygen, Fn func)
+		{
+			affine_map r{};
+			fill(r, nullptr, keygen, func);
+			r.layout = l;
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr affine_map build(std::false_type,
+			const affine_layout& l, KeyGen keygen, Fn func)
+		{
+			return build(l, gen_seq<N>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is>
+		static constexpr affine_map build(const affine_layout& l,
+			seq<Is...>, KeyGen keygen, Fn func)
+		{
+			return { { keygen(Is)... }, { func(keygen(Is))... }, l };
+		}
+		#endif
+
+		/**
+		 * Find the index of key in keys.
+		 *
+		 * This is O(1) (see affine_index()).
+		 *
+		 * \param key The key to search for in keys
+		 * \return The index of key in keys (i.e., keys[i] == key), or N
+		 * if key is not in this map
+		 */
+		constexpr unsigned find(K key) const {
+			const std::uint64_t i = affine_index(layout, static_cast<std::uint64_t>(key));
+			return (i < N) ? static_cast<unsigned>(i) : N;
+		}
+
+		///get the index of key in keys (see linear_map::index_of())
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return i;
+		}
+
+		///look up key (see linear_map::operator[]())
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	/**
+	 * The result of building a minimal perfect hash.
+	 *
+	 * \tparam N The number of keys
+	 * \tparam B The number of buckets
+	 */
+	template <unsigned N, unsigned B>
+	struct phf_layout {
+		///whether a perfect hash was found
+		bool ok;
+		///the seed passed to static_hash
+		std::uint64_t seed;
+		///the displacement of each bucket
+		std::uint32_t disp[B];
+		///order[s] is the generator index of the key stored in slot s
+		unsigned order[N];
+		///slot_of[i] is the slot where generator index i is stored
+		unsigned slot_of[N];
+	};
+
+	///how many seeds phf_build tries before giving up
+	static constexpr unsigned phf_max_seeds = 16;
+	///how many displacements phf_build tries per bucket and seed
+	static constexpr std::uint32_t phf_max_tries = 1U << 12;
+
+	///the seed that phf_build passes to static_hash on an attempt
+	static constexpr std::uint64_t phf_seed(unsigned attempt) {
+		return static_hash<std::uint64_t>{}(attempt, 0x9e3779b97f4a7c15ULL);
+	}
+
+	/**
+	 * Scratch space for phf_place(), for N keys and B buckets.
+	 *
+	 * frozen_map passes its own type with vectors of the same sizes
+	 * instead.
+	 */
+	template <unsigned N, unsigned B>
+	struct phf_work {
+		///B + 1 bucket boundaries
+		unsigned start[B + 1];
+		///N keys, grouped by bucket
+		unsigned members[N];
+		///B buckets, largest first
+		unsigned by_size[B];
+		///max(B, N + 2) counters
+		unsigned count[(B > N + 2) ? B : N + 2];
+		///N slot flags
+		bool used[N];
+	};
+
+	///the outcome of phf_place()
+	enum phf_result {
+		///every key was placed
+		phf_placed,
+		///some bucket could not be placed; try another seed
+		phf_retry,
+		///two keys are equal, so no seed will work
+		phf_duplicate
+	};
+
+	/**
+	 * Place hashed keys in a minimal perfect hash.
+	 *
+	 * This is a hash-and-displace (CHD-like) scheme.  The high half of
+	 * the hash h of a key picks one of b buckets, and the key lands in
+	 * slot phf_slot(h, disp[bucket], n).  Buckets are placed largest
+	 * first, each trying displacements until all of its keys land in
+	 * free slots.  Buckets holding a single key are placed last,
+	 * directly into whatever slots remain, so the hash is minimal:
+	 * every one of the n slots holds exactly one key.
+	 *
+	 * This is shared by phf_build() and frozen_map, so it works on
+	 * arrays of any size.
+	 *
+	 * \param h The hash of each key
+	 * \param n The number of keys
+	 * \param b The number of buckets
+	 * \param same same(i, j) tells if keys i and j are equal
+	 * \param w Scratch space
+	 * \param disp Receives the displacement of each bucket
+	 * \param order Receives the key index stored in each slot
+	 * \param slot_of Receives the slot of each key index
+	 * \return Whether the keys were placed
+	 */
+	template <class Hashes, class Same, class Work, class Disp, class Slots>
+	static constexpr phf_result phf_place(const Hashes& h, unsigned n,
+		unsigned b, Same same, Work& w, Disp& disp, Slots& order, Slots& slot_of)
+	{
+		//bucket c holds members[start[c]] ... members[start[c+1]-1]
+		auto& start = w.start;
+		auto& members = w.members;
+		auto& count = w.count;
+		auto& used = w.used;
+		for (unsigned c = 0; c <= b; ++c) {
+			start[c] = 0;
+		}
+		for (unsigned i = 0; i < n; ++i) {
+			++start[(h[i] >> 32) % b + 1];
+			used[i] = false;
+		}
+		unsigned largest = 0;
+		for (unsigned c = 0; c < b; ++c) {
+			largest = (start[c + 1] > largest) ? start[c + 1] : largest;
+			start[c + 1] += start[c];
+			count[c] = 0;
+		}
+		for (unsigned i = 0; i < n; ++i) {
+			const unsigned c = (h[i] >> 32) % b;
+			members[start[c] + count[c]++] = i;
+		}
+		//counting sort of the buckets by decreasing size
+		for (unsigned c = 0; c <= largest + 1; ++c) {
+			count[c] = 0;
+		}
+		for (unsigned c = 0; c < b; ++c) {
+			++count[largest - (start[c + 1] - start[c]) + 1];
+		}
+		for (unsigned c = 1; c <= largest + 1; ++c) {
+			count[c] += count[c - 1];
+		}
+		for (unsigned c = 0; c < b; ++c) {
+			w.by_size[count[largest - (start[c + 1] - start[c])]++] = c;
+		}
+		//duplicate keys can never be separated, so bail out early
+		for (unsigned c = 0; c < b; ++c) {
+			for (unsigned x = start[c]; x < start[c + 1]; ++x) {
+				for (unsigned y = x + 1; y < start[c + 1]; ++y) {
+					if (h[members[x]] == h[members[y]] && same(members[x], members[y])) {
+						return phf_duplicate;
+					}
+				}
+			}
+		}
+		for (unsigned next = 0; next < b; ++next) {
+			const unsigned c = w.by_size[next];
+			if (start[c + 1] - start[c] < 2) {
+				break;
+			}
+			bool placed = false;
+			for (std::uint32_t d = 1; d <= phf_max_tries && !placed; ++d) {
+				unsigned k = start[c];
+				for (; k < start[c + 1]; ++k) {
+					const unsigned s = phf_slot(h[members[k]], d, n);
+					if (used[s]) {
+						break;
+					}
+					used[s] = true;
+				}
+				if (k == start[c + 1]) {
+					placed = true;
+					disp[c] = d;
+				}
+				else {
+					//roll back the slots this attempt claimed
+					for (unsigned j = start[c]; j < k; ++j) {
+						used[phf_slot(h[members[j]], d, n)] = false;
+					}
+				}
+			}
+			if (!placed) {
+				return phf_retry;
+			}
+		}
+		//singletons go straight into the remaining free slots
+		unsigned next_free = 0;
+		for (unsigned c = 0; c < b; ++c) {
+			if (start[c + 1] - start[c] == 1) {
+				while (used[next_free]) {
+					++next_free;
+				}
+				used[next_free] = true;
+				disp[c] = static_cast<std::uint32_t>(h[members[start[c]]]) ^
+					unmix32(next_free);
+			}
+		}
+		for (unsigned i = 0; i < n; ++i) {
+			const unsigned s = phf_slot(h[i], disp[(h[i] >> 32) % b], n);
+			order[s] = i;
+			slot_of[i] = s;
+		}
+		return phf_placed;
+	}
+
+	///compares generated keys for phf_place()
+	template <class KeyGen>
+	struct same_generated {
+		KeyGen keygen;
+		constexpr bool operator()(unsigned i, unsigned j) {
+			return keygen(i) == keygen(j);
+		}
+	};
+
+	/**
+	 * Build a minimal perfect hash for the keys produced by keygen.
+	 *
+	 * This tries phf_place() with up to phf_max_seeds seeds.  If the
+	 * keys contain duplicates, no perfect hash exists and the result
+	 * has ok == false.
+	 *
+	 * \param keygen The key generator
+	 * \return The layout of the hash table
+	 */
+	template <unsigned N, unsigned B, class K, class KeyGen>
+	static constexpr phf_layout<N, B> phf_build(KeyGen keygen) {
+		phf_layout<N, B> r{};
+		std::uint64_t h[N] = {};
+		phf_work<N, B> w{};
+		for (unsigned attempt = 0; attempt < phf_max_seeds; ++attempt) {
+			r.seed = phf_seed(attempt);
+			for (unsigned i = 0; i < N; ++i) {
+				h[i] = static_hash<K>{}(keygen(i), r.seed);
+			}
+			const phf_result placed = phf_place(h, N, B,
+				same_generated<KeyGen>{ keygen }, w, r.disp, r.order, r.slot_of);
+			if (placed != phf_retry) {
+				r.ok = (placed == phf_placed);
+				return r;
+			}
+		}
+		r.ok = false;
+		return r;
+	}
+
+	/**
+	 * Whether phf_build succeeds for the keys produced by KeyGen.
+	 *
+	 * This is only evaluated if Try is true, so that keys which cannot
+	 * be hashed never instantiate phf_build.
+	 */
+	template <bool Try, unsigned N, unsigned B, class K, class KeyGen>
+	static constexpr typename std::enable_if<Try, bool>::type phf_ok() {
+		return phf_build<N, B, K>(KeyGen()).ok;
+	}
+
+	#ifndef DOXYGEN
+	template <bool Try, unsigned N, unsigned B, class K, class KeyGen>
+	static constexpr typename std::enable_if<!Try, bool>::type phf_ok() {
+		return false;
+	}
+	#endif
+
+	/**
+	 * Storage for a map indexed by a minimal perfect hash.
+	 *
+	 * Keys and values are stored in hash slot order.  A lookup takes
+	 * one hash, one read of the displacement table and one key
+	 * comparison, regardless of N.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct hash_map {
+		///the number of buckets (about one key per bucket)
+		static constexpr unsigned buckets = N + 1;
+		///the array of keys, in slot order
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+		///the displacement of each bucket
+		std::uint32_t disp[buckets];
+		///slot_of[i] is the slot of the ith generated entry
+		unsigned slot_of[N];
+		///the seed passed to static_hash
+		std::uint64_t seed;
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr hash_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(), phf_build<N, buckets, K>(keygen),
+				keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr hash_map build(std::true_type,
+			const phf_layout<N, buckets>& l, KeyGen keygen, Fn func)
+		{
+			hash_map r{};
+			fill(r, l.order, keygen, func);
+			for (unsigned b = 0; b < buckets; ++b) {
+				r.disp[b] = l.disp[b];
+			}
+			for (unsigned i = 0; i < N; ++i) {
+				r.slot_of[i] = l.slot_of[i];
+			}
+			r.seed = l.seed;
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr hash_map build(std::false_type,
+			const phf_layout<N, buckets>& l, KeyGen keygen, Fn func)
+		{
+			return build(l, gen_seq<N>(), gen_seq<buckets>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is, unsigned... Bs>
+		static constexpr hash_map build(const phf_layout<N, buckets>& l,
+			seq<Is...>, seq<Bs...>, KeyGen keygen, Fn func)
+		{
+			return {
+				{ keygen(l.order[Is])... },
+				{ func(keygen(l.order[Is]))... },
+				{ l.disp[Bs]... },
+				{ l.slot_of[Is]... },
+				l.seed
+			};
+		}
+		#endif
+
+		/**
+		 * Find the slot of key in keys.
+		 *
+		 * This hashes key and checks the only slot it could be in.
+		 * This is O(1).
+		 *
+		 * \param key The key to search for in keys
+		 * \return The index of key in keys (i.e., keys[i] == key), or N
+		 * if key is not in this map
+		 */
+		constexpr unsigned find(K key) const {
+			const std::uint64_t h = static_hash<K>{}(key, seed);
+			const unsigned s = phf_slot<N>(h, disp[(h >> 32) % buckets]);
+			return (keys[s] == key) ? s : N;
+		}
+
+		///get the index of key in keys (see linear_map::index_of())
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return slot_of[i];
+		}
+
+		///look up key (see linear_map::operator[]())
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	///a key stored next to its value, or part of it
+	template <class K, class V>
+	struct entry {
+		K key;
+		V value;
+	};
+
+	/**
+	 * Storage for a perfectly hashed map with interleaved entries.
+	 *
+	 * This is hash_map with each key stored next to its value (see
+	 * static_storage::interleaved), so a hit reads one place.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct interleaved_hash_map {
+		///the number of buckets (as in hash_map)
+		static constexpr unsigned buckets = hash_map<N, K, V>::buckets;
+		///the (key, value) pairs, in slot order
+		entry<K, V> entries[N];
+		///the displacement of each bucket
+		std::uint32_t disp[buckets];
+		///slot_of[i] is the slot of the ith generated entry
+		unsigned slot_of[N];
+		///the seed passed to static_hash
+		std::uint64_t seed;
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr interleaved_hash_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(), phf_build<N, buckets, K>(keygen),
+				keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr interleaved_hash_map build(std::true_type,
+			const phf_layout<N, buckets>& l, KeyGen keygen, Fn func)
+		{
+			interleaved_hash_map r{};
+			for (unsigned s = 0; s < N; ++s) {
+				r.entries[s].key = keygen(l.order[s]);
+				r.entries[s].value = func(r.entries[s].key);
+			}
+			for (unsigned b = 0; b < buckets; ++b) {
+				r.disp[b] = l.disp[b];
+			}
+			for (unsigned i = 0; i < N; ++i) {
+				r.slot_of[i] = l.slot_of[i];
+			}
+			r.seed = l.seed;
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr interleaved_hash_map build(std::false_type,
+			const phf_layout<N, buckets>& l, KeyGen keygen, Fn func)
+		{
+			return build(l, gen_seq<N>(), gen_seq<buckets>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is, unsigned... Bs>
+		static constexpr interleaved_hash_map build(const phf_layout<N, buckets>& l,
+			seq<Is...>, seq<Bs...>, KeyGen keygen, Fn func)
+		{
+			return {
+				{ { keygen(l.order[Is]), func(keygen(l.order[Is])) }... },
+				{ l.disp[Bs]... },
+				{ l.slot_of[Is]... },
+				l.seed
+			};
+		}
+		#endif
+
+		///find the slot of key (see hash_map::find())
+		constexpr unsigned find(K key) const {
+			const std::uint64_t h = static_hash<K>{}(key, seed);
+			const unsigned s = phf_slot<N>(h, disp[(h >> 32) % buckets]);
+			return (entries[s].key == key) ? s : N;
+		}
+
+		///the position in entries of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return slot_of[i];
+		}
+	};
+
+	/**
+	 * Storage for a perfectly hashed map split into hot and cold parts.
+	 *
+	 * This is hash_map with each key stored next to the hot field of
+	 * its value (see static_storage::hot_cold).  The whole values are
+	 * stored in a separate array, so a lookup of the hot field reads
+	 * one place and a lookup of the value reads two, as in hash_map.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 * \tparam Hot Maps a value to its hot field
+	 */
+	template <unsigned N, class K, class V, class Hot>
+	struct hot_cold_hash_map {
+		///the type of the hot field
+		typedef typename std::decay<decltype((Hot{})(std::declval<const V&>()))>::type H;
+		///the number of buckets (as in hash_map)
+		static constexpr unsigned buckets = hash_map<N, K, V>::buckets;
+		///the (key, hot field) pairs, in slot order
+		entry<K, H> entries[N];
+		///the values, in slot order
+		V values[N];
+		///the displacement of each bucket
+		std::uint32_t disp[buckets];
+		///slot_of[i] is the slot of the ith generated entry
+		unsigned slot_of[N];
+		///the seed passed to static_hash
+		std::uint64_t seed;
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr hot_cold_hash_map build(KeyGen keygen, Fn func) {
+			return build(std::integral_constant<bool, loop_buildable<K, V>::value &&
+				std::is_default_constructible<H>::value>(),
+				phf_build<N, buckets, K>(keygen), keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr hot_cold_hash_map build(std::true_type,
+			const phf_layout<N, buckets>& l, KeyGen keygen, Fn func)
+		{
+			hot_cold_hash_map r{};
+			for (unsigned s = 0; s < N; ++s) {
+				r.entries[s].key = keygen(l.order[s]);
+				r.values[s] = func(r.entries[s].key);
+				r.entries[s].value = Hot{}(r.values[s]);
+			}
+			for (unsigned b = 0; b < buckets; ++b) {
+				r.disp[b] = l.disp[b];
+			}
+			for (unsigned i = 0; i < N; ++i) {
+				r.slot_of[i] = l.slot_of[i];
+			}
+			r.seed = l.seed;
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr hot_cold_hash_map build(std::false_type,
+			const phf_layout<N, buckets>& l, KeyGen keygen, Fn func)
+		{
+			return build(l, gen_seq<N>(), gen_seq<buckets>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is, unsigned... Bs>
+		static constexpr hot_cold_hash_map build(const phf_layout<N, buckets>& l,
+			seq<Is...>, seq<Bs...>, KeyGen keygen, Fn func)
+		{
+			return {
+				{ { keygen(l.order[Is]), Hot{}(func(keygen(l.order[Is]))) }... },
+				{ func(keygen(l.order[Is]))... },
+				{ l.disp[Bs]... },
+				{ l.slot_of[Is]... },
+				l.seed
+			};
+		}
+		#endif
+
+		///find the slot of key (see hash_map::find())
+		constexpr unsigned find(K key) const {
+			const std::uint64_t h = static_hash<K>{}(key, seed);
+			const unsigned s = phf_slot<N>(h, disp[(h >> 32) % buckets]);
+			return (entries[s].key == key) ? s : N;
+		}
+
+		///the position in entries and values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return slot_of[i];
+		}
+	};
+
+	/**
+	 * The key stored in a slot of a map's storage.
+	 *
+	 * The storage types keep keys and values in arrays of their own,
+	 * except for the layouts of static_storage, which these are
+	 * overloaded for.
+	 *
+	 * \param map The storage
+	 * \param s The slot
+	 * \return The key in slot s
+	 */
+	template <class Map>
+	static constexpr auto stored_key(const Map& map, unsigned s) -> decltype((map.keys[s])) {
+		return map.keys[s];
+	}
+
+	///the value stored in a slot of a map's storage (see stored_key())
+	template <class Map>
+	static constexpr auto stored_value(const Map& map, unsigned s) -> decltype((map.values[s])) {
+		return map.values[s];
+	}
+
+	#ifndef DOXYGEN
+	template <unsigned N, class K, class V>
+	static constexpr const K& stored_key(const interleaved_hash_map<N, K, V>& map, unsigned s) {
+		return map.entries[s].key;
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr const V& stored_value(const interleaved_hash_map<N, K, V>& map, unsigned s) {
+		return map.entries[s].value;
+	}
+
+	template <unsigned N, class K, class V, class Hot>
+	static constexpr const K& stored_key(const hot_cold_hash_map<N, K, V, Hot>& map, unsigned s) {
+		return map.entries[s].key;
+	}
+	#endif
+
+	/**
+	 * Storage for a map with sorted keys in Eytzinger order.
+	 *
+	 * The keys are stored as an implicit binary search tree in
+	 * breadth-first order, so the first levels of every search share a
+	 * few cache lines and the nodes several levels down from the
+	 * current one are contiguous and can be prefetched.  The search
+	 * loop has no data-dependent branches.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct eytzinger_map {
+		///how many keys share a cache line (assuming 64 byte lines)
+		static constexpr unsigned per_line =
+			(sizeof(K) < 64) ? 64 / sizeof(K) : 1;
+		///the array of keys, in Eytzinger order
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+		///slot_of[i] is the slot of the ith generated entry
+		unsigned slot_of[N];
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr eytzinger_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(), eytzinger_build<N>(), keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr eytzinger_map build(std::true_type,
+			const permutation<N>& p, KeyGen keygen, Fn func)
+		{
+			eytzinger_map r{};
+			fill(r, p.order, keygen, func);
+			for (unsigned i = 0; i < N; ++i) {
+				r.slot_of[i] = p.slot_of[i];
+			}
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr eytzinger_map build(std::false_type,
+			const permutation<N>& p, KeyGen keygen, Fn func)
+		{
+			return build(p, gen_seq<N>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is>
+		static constexpr eytzinger_map build(const permutation<N>& p,
+			seq<Is...>, KeyGen keygen, Fn func)
+		{
+			return {
+				{ keygen(p.order[Is])... },
+				{ func(keygen(p.order[Is]))... },
+				{ p.slot_of[Is]... }
+			};
+		}
+		#endif
+
+		/**
+		 * Find the slot of key in keys.
+		 *
+		 * This descends the implicit tree without branching on the
+		 * comparisons, prefetching the keys lg(per_line) levels below
+		 * the current node.  The final node index encodes the path
+		 * taken; stripping the trailing right turns yields the lower
+		 * bound of key.  This is O(lg(N)).
+		 *
+		 * \param key The key to search for in keys
+		 * \return The index of key in keys (i.e., keys[i] == key), or N
+		 * if key is not in this map
+		 */
+		constexpr unsigned find(K key) const {
+			const unsigned k = lower_node(key);
+			return (k != 0 && keys[k - 1] == key) ? k - 1 : N;
+		}
+
+		/**
+		 * Find the node of the lower bound of key.
+		 *
+		 * This is the descent that find() performs.
+		 *
+		 * \param key The key to search for
+		 * \return The 1-based node number of the first key that is not
+		 * less than key, or 0 if there is none
+		 */
+		constexpr unsigned lower_node(K key) const {
+			unsigned k = 1;
+			while (k <= N) {
+				prefetch(keys + ((k*per_line <= N) ? k*per_line - 1 : 0));
+				k = 2*k + (keys[k - 1] < key);
+			}
+			return last_left_turn(k);
+		}
+
+		///get the index of key in keys (see linear_map::index_of())
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return slot_of[i];
+		}
+
+		///look up key (see linear_map::operator[]())
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	/**
+	 * A piecewise linear model of sorted integer keys.
+	 *
+	 * Keys are measured as their distance d from the smallest key.
+	 * Segment d >> shift covers a fixed slice of that key space, so
+	 * picking a segment is exact integer arithmetic.  Each segment fits
+	 * a line through its first and last key and records how far any of
+	 * its keys is from where the line puts it.
+	 *
+	 * \tparam S The number of segments
+	 */
+	template <unsigned S>
+	struct learned_model {
+		///the key space covered by each segment is 2^shift wide
+		unsigned shift;
+		///the largest error of any segment
+		unsigned max_error;
+		///the distance of the first key of each segment
+		std::uint64_t base[S];
+		///how many positions each segment advances per unit of distance
+		double slope[S];
+		///segment s holds positions first[s] ... first[s+1]-1
+		unsigned first[S + 1];
+		///the largest distance of any key in each segment from its
+		///predicted position
+		unsigned error[S];
+	};
+
+	///the distance of key from lo, for integral or enumeration keys
+	template <class K>
+	static constexpr std::uint64_t key_distance(K key, K lo) {
+		return static_cast<std::uint64_t>(key) - static_cast<std::uint64_t>(lo);
+	}
+
+	/**
+	 * Predict the position of a key within a segment.
+	 *
+	 * \return The offset from the first position of the segment
+	 */
+	template <unsigned S>
+	static constexpr unsigned learned_predict(const learned_model<S>& m,
+		unsigned s, std::uint64_t d)
+	{
+		return (d > m.base[s]) ?
+			static_cast<unsigned>(static_cast<double>(d - m.base[s]) * m.slope[s]) : 0;
+	}
+
+	/**
+	 * Fit a learned_model to the sorted keys produced by keygen.
+	 *
+	 * \param keygen The key generator
+	 * \return The fitted model
+	 */
+	template <unsigned N, unsigned S, class K, class KeyGen>
+	static constexpr learned_model<S> learned_build(KeyGen keygen) {
+		learned_model<S> m{};
+		const K lo = keygen(0);
+		const std::uint64_t span = key_distance(keygen(N - 1), lo);
+		//the smallest shift that uses no more than S segments
+		while ((span >> m.shift) >= S) {
+			++m.shift;
+		}
+		for (unsigned i = 0; i < N; ++i) {
+			++m.first[(key_distance(keygen(i), lo) >> m.shift) + 1];
+		}
+		for (unsigned s = 0; s < S; ++s) {
+			m.first[s + 1] += m.first[s];
+		}
+		for (unsigned s = 0; s < S; ++s) {
+			if (m.first[s] == m.first[s + 1]) {
+				continue;
+			}
+			const unsigned last = m.first[s + 1] - 1;
+			m.base[s] = key_distance(keygen(m.first[s]), lo);
+			const std::uint64_t top = key_distance(keygen(last), lo);
+			m.slope[s] = (top > m.base[s]) ?
+				static_cast<double>(last - m.first[s]) /
+					static_cast<double>(top - m.base[s]) :
+				0.0;
+			for (unsigned i = m.first[s]; i <= last; ++i) {
+				const unsigned p = m.first[s] +
+					learned_predict(m, s, key_distance(keygen(i), lo));
+				const unsigned e = (p > i) ? p - i : i - p;
+				m.error[s] = (e > m.error[s]) ? e : m.error[s];
+			}
+			m.max_error = (m.error[s] > m.max_error) ? m.error[s] : m.max_error;
+		}
+		return m;
+	}
+
+	/**
+	 * Storage for a map with sorted keys and a learned index.
+	 *
+	 * The layout is the same as sorted_map, plus a learned_model with
+	 * one segment per 16 keys.  find() predicts the position of the key
+	 * and binary searches only the positions within the error of that
+	 * prediction, so near-linear keys take one or two probes.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam K The key type
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class K, class V>
+	struct learned_map {
+		static_assert(std::is_integral<K>::value || std::is_enum<K>::value,
+			"static_search::interpolation requires integral or enumeration keys");
+		///the number of segments
+		static constexpr unsigned segments = N/16 + 2;
+		///the array of keys
+		K keys[N];
+		///the array of values such that keys[i] maps to values[i]
+		V values[N];
+		///the model of the keys
+		learned_model<segments> model;
+
+		///also can have length here for convenience's sake
+		static constexpr unsigned length = N;
+
+		///build the map from the generators
+		template <class KeyGen, class Fn>
+		static constexpr learned_map build(KeyGen keygen, Fn func) {
+			return build(loop_buildable<K, V>(),
+				learned_build<N, segments, K>(keygen), keygen, func);
+		}
+
+		#ifndef DOXYGEN
+		template <class KeyGen, class Fn>
+		static constexpr learned_map build(std::true_type,
+			const learned_model<segments>& m, KeyGen keygen, Fn func)
+		{
+			learned_map r{};
+			fill(r, nullptr, keygen, func);
+			r.model = m;
+			return r;
+		}
+
+		template <class KeyGen, class Fn>
+		static constexpr learned_map build(std::false_type,
+			const learned_model<segments>& m, KeyGen keygen, Fn func)
+		{
+			return build(m, gen_seq<N>(), keygen, func);
+		}
+
+		template <class KeyGen, class Fn, unsigned... Is>
+		static constexpr learned_map build(const learned_model<segments>& m,
+			seq<Is...>, KeyGen keygen, Fn func)
+		{
+			return { { keygen(Is)... }, { func(keygen(Is))... }, m };
+		}
+		#endif
+
+		/**
+		 * Find the index of key in keys.
+		 *
+		 * This is the lower bound (see lower()) if it is equal to key.
+		 * This is O(1) if the errors are bounded, and O(lg(N)) in the
+		 * worst case.
+		 *
+		 * \param key The key to search for in keys
+		 * \return The index of key in keys (i.e., keys[i] == key), or N
+		 * if key is not in this map
+		 */
+		constexpr unsigned find(K key) const {
+			const unsigned i = lower(key);
+			return (i != N && keys[i] == key) ? i : N;
+		}
+
+		/**
+		 * Find the lower bound of key.
+		 *
+		 * This picks the key's segment, predicts its position with the
+		 * segment's line and binary searches the positions within the
+		 * segment's error of the prediction.  The window is widened by
+		 * one position on each side in case the prediction rounds
+		 * differently at runtime (e.g. on x87).  The model is monotone,
+		 * so a missing key is predicted between its neighbours and its
+		 * lower bound is in the window too.
+		 *
+		 * \param key The key to search for
+		 * \return The index of the first key that is not less than key,
+		 * or N if there is none
+		 */
+		constexpr unsigned lower(K key) const {
+			if (!(keys[0] < key)) {
+				return 0;
+			}
+			if (keys[N - 1] < key) {
+				return N;
+			}
+			const std::uint64_t d = key_distance(key, keys[0]);
+			const unsigned s = d >> model.shift;
+			const unsigned p = learned_predict(model, s, d);
+			const unsigned reach = model.error[s] + 1;
+			const unsigned begin = model.first[s] + ((p > reach) ? p - reach : 0);
+			unsigned end = model.first[s] + p + reach + 1;
+			end = (end < model.first[s + 1]) ? end : model.first[s + 1];
+			return (begin < end) ? begin + binary_lower(keys + begin, key, end - begin) : end;
+		}
+
+		///get the index of key in keys (see linear_map::index_of())
+		constexpr unsigned index_of(K key) const {
+			return checked_index<N>(find(key));
+		}
+
+		///the position in keys/values of the ith generated entry
+		constexpr unsigned slot(unsigned i) const {
+			return i;
+		}
+
+		///look up key (see linear_map::operator[]())
+		constexpr V operator[](K key) const {
+			return values[index_of(key)];
+		}
+	};
+
+	/**
+	 * The in-order rank of a node of an Eytzinger layout.
+	 *
+	 * This adds up the sizes of the subtrees to the left of the node,
+	 * which takes O(lg(N)^2) steps.
+	 *
+	 * \param k The 1-based node number
+	 * \return The number of nodes before k in sorted order
+	 */
+	template <unsigned N>
+	static constexpr unsigned eytzinger_rank(unsigned k) {
+		unsigned r = eytzinger_size<N>(2*k);
+		for (; k > 1; k >>= 1) {
+			//a right child comes after its parent and its left sibling
+			if (k & 1) {
+				r += eytzinger_size<N>(k - 1) + 1;
+			}
+		}
+		return r;
+	}
+
+	///the number of nodes in the subtree rooted at node k
+	template <unsigned N>
+	static constexpr unsigned eytzinger_size(unsigned k) {
+		unsigned size = 0;
+		//each level of the subtree is the range [lo, lo + width)
+		for (std::uint64_t lo = k, width = 1; lo <= N; lo *= 2, width *= 2) {
+			size += static_cast<unsigned>(((lo + width <= N + 1ULL) ? lo + width : N + 1ULL) - lo);
+		}
+		return size;
+	}
+
+	/**
+	 * Find the lower bound of a key in a map with sorted keys.
+	 *
+	 * This is the generic version, which binary searches the keys in
+	 * generator order through slot().  The overloads below use each
+	 * storage type's own search.
+	 *
+	 * \param map The storage to search
+	 * \param key The key to search for
+	 * \return The number of keys less than key
+	 */
+	template <class Map, class K>
+	static constexpr unsigned lower_rank(const Map& map, K key) {
+		unsigned begin = 0;
+		unsigned end = Map::length;
+		while (begin < end) {
+			const unsigned mid = midpoint(begin, end);
+			if (stored_key(map, map.slot(mid)) < key) {
+				begin = mid + 1;
+			}
+			else {
+				end = mid;
+			}
+		}
+		return begin;
+	}
+
+	#ifndef DOXYGEN
+	template <unsigned N, class K, class V>
+	static constexpr unsigned lower_rank(const sorted_map<N, K, V>& map, K key) {
+		return binary_lower(map.keys, key, N);
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr unsigned lower_rank(const permuted_map<N, K, V>& map, K key) {
+		return binary_lower(map.keys, key, N);
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr unsigned lower_rank(const eytzinger_map<N, K, V>& map, K key) {
+		const unsigned k = map.lower_node(key);
+		return (k != 0) ? eytzinger_rank<N>(k) : N;
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr unsigned lower_rank(const learned_map<N, K, V>& map, K key) {
+		return map.lower(key);
+	}
+
+	//sorted keys in arithmetic progression: divide and round up
+	template <unsigned N, class K, class V>
+	static constexpr unsigned lower_rank(const affine_map<N, K, V>& map, K key) {
+		if (!(map.keys[0] < key)) {
+			return 0;
+		}
+		if (map.keys[N - 1] < key) {
+			return N;
+		}
+		const std::uint64_t stride = key_distance(map.keys[1], map.keys[0]);
+		const std::uint64_t d = key_distance(key, map.keys[0]);
+		return static_cast<unsigned>(d / stride + (d % stride != 0));
+	}
+	#endif
+
+	/**
+	 * Map sorted order to slots.
+	 *
+	 * If a static_map's keys are sorted in generator order, the ith
+	 * smallest key is the ith generated one.  Storage types that
+	 * reorder the entries keep slot_of for that, and the others store
+	 * the entries in sorted order.
+	 *
+	 * \param map The storage
+	 * \return The slot of each rank, or null for the identity
+	 */
+	template <class Map>
+	static constexpr const unsigned* rank_slots(const Map&) {
+		return nullptr;
+	}
+
+	#ifndef DOXYGEN
+	template <unsigned N, class K, class V>
+	static constexpr const unsigned* rank_slots(const eytzinger_map<N, K, V>& map) {
+		return map.slot_of;
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr const unsigned* rank_slots(const hash_map<N, K, V>& map) {
+		return map.slot_of;
+	}
+
+	template <unsigned N, class K, class V, class Profile>
+	static constexpr const unsigned* rank_slots(const profiled_map<N, K, V, Profile>& map) {
+		return map.slot_of;
+	}
+	#endif
+
+	///the number of steps a binary search of n keys takes, lg(n + 1)
+	///rounded up
+	static constexpr unsigned search_depth(unsigned n) {
+		unsigned d = 0;
+		for (std::uint64_t m = std::uint64_t{n} + 1; m > 1; m = (m + 1) / 2) {
+			++d;
+		}
+		return d;
+	}
+
+	/**
+	 * How many probes a lookup took, for instrumentation.
+	 *
+	 * This is the number of keys compared, or buckets read, by the
+	 * search that found slot.  Linear searches report how far they
+	 * scanned; binary searches report the depth of the search, which
+	 * is the same for every key.  This generic version is for the maps
+	 * that look in one place.
+	 *
+	 * \param map The storage that was searched
+	 * \param slot The slot that the search found, or Map::length
+	 * \return The number of probes
+	 */
+	template <class Map, class K>
+	static constexpr unsigned probe_steps(const Map&, const K&, unsigned) {
+		return 1;
+	}
+
+	#ifndef DOXYGEN
+	template <unsigned N, class K, class V>
+	static constexpr unsigned probe_steps(const linear_map<N, K, V>&, const K&, unsigned slot) {
+		return (slot != N) ? slot + 1 : N;
+	}
+
+	template <unsigned N, class K, class V, class Profile>
+	static constexpr unsigned probe_steps(const profiled_map<N, K, V, Profile>&,
+		const K&, unsigned slot)
+	{
+		return (slot != N) ? slot + 1 : N;
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr unsigned probe_steps(const sorted_map<N, K, V>&, const K&, unsigned) {
+		return search_depth(N);
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr unsigned probe_steps(const permuted_map<N, K, V>&, const K&, unsigned) {
+		return search_depth(N);
+	}
+
+	template <unsigned N, class K, class V>
+	static constexpr unsigned probe_steps(const eytzinger_map<N, K, V>&, const K&, unsigned) {
+		return search_depth(N);
+	}
+
+	//the bounded search covers 2*max_error + 3 positions
+	template <unsigned N, class K, class V>
+	static constexpr unsigned probe_steps(const learned_map<N, K, V>& map, const K&, unsigned) {
+		return 1 + search_depth(2 * map.model.max_error + 3);
+	}
+	#endif
+
+	/**
+	 * The instruction sets that the batch lookups can use.
+	 */
+	enum simd_level {
+		simd_scalar,
+		simd_sse2,
+		simd_avx2
+	};
+
+	/**
+	 * Detect the best instruction set supported by this CPU.
+	 *
+	 * The check is done once and cached.
+	 *
+	 * \return The best simd_level available
+	 */
+	static simd_level simd() {
+		#ifdef STATIC_TABLE_X86_SIMD
+		static const simd_level level =
+			__builtin_cpu_supports("avx2") ? simd_avx2 :
+			__builtin_cpu_supports("sse2") ? simd_sse2 : simd_scalar;
+		return level;
+		#else
+		return simd_scalar;
+		#endif
+	}
+
+	/**
+	 * Whether the SIMD linear search kernels can compare keys of type K.
+	 *
+	 * Keys are compared bitwise, so only 32 bit integers and enums
+	 * qualify.
+	 */
+	template <class K>
+	struct simd_key {
+		static constexpr bool value = (sizeof(K) == 4) &&
+			(std::is_integral<K>::value || std::is_enum<K>::value);
+	};
+
+	/**
+	 * Whether the SIMD gather kernels can load values of type V.
+	 *
+	 * Values are copied bitwise, so any trivially copyable 4 or 8 byte
+	 * type qualifies.
+	 */
+	template <class V>
+	struct simd_value {
+		static constexpr bool value = (sizeof(V) == 4 || sizeof(V) == 8) &&
+			std::is_trivially_copyable<V>::value;
+	};
+
+	/**
+	 * Find the slots of several keys.
+	 *
+	 * This is the generic version, which calls find() on each key.
+	 *
+	 * \tparam Width How many searches to interleave, where supported
+	 * \param map The storage to search
+	 * \param keys The keys to search for
+	 * \param slots Receives find(keys[j]) for each j
+	 * \param n The number of keys
+	 */
+	template <unsigned Width, class Map, class K>
+	static void find_batch(const Map& map, const K* keys, unsigned* slots, unsigned n) {
+		for (unsigned j = 0; j < n; ++j) {
+			slots[j] = map.find(keys[j]);
+		}
+	}
+
+	#ifndef DOXYGEN
+	//linear search of 32 bit keys: compare 4 or 8 keys at a time.
+	//these must find the *first* match to agree with linear_map::find().
+	template <unsigned Width, unsigned N, class K, class V>
+	static typename std::enable_if<simd_key<K>::value>::type
+	find_batch(const linear_map<N, K, V>& map, const K* keys, unsigned* slots, unsigned n) {
+		switch (simd()) {
+		#ifdef STATIC_TABLE_X86_SIMD
+		case simd_avx2:
+			find_batch_avx2<N>(map.keys, keys, slots, n);
+			return;
+		case simd_sse2:
+			find_batch_sse2<N>(map.keys, keys, slots, n);
+			return;
+		#endif
+		default:
+			for (unsigned j = 0; j < n; ++j) {
+				slots[j] = map.find(keys[j]);
+			}
+		}
+	}
+
+	#ifdef STATIC_TABLE_X86_SIMD
+	template <unsigned N, class K>
+	__attribute__((target("avx2")))
+	static void find_batch_avx2(const K* table, const K* keys, unsigned* slots, unsigned n) {
+		for (unsigned j = 0; j < n; ++j) {
+			const __m256i key = _mm256_set1_epi32(static_cast<int>(keys[j]));
+			unsigned i = 0;
+			unsigned slot = N;
+			for (; i + 8 <= N && slot == N; i += 8) {
+				const __m256i block = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(table + i));
+				const int mask = _mm256_movemask_ps(
+					_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, key)));
+				slot = mask ? i + __builtin_ctz(mask) : N;
+			}
+			for (; i < N && slot == N; ++i) {
+				slot = (table[i] == keys[j]) ? i : N;
+			}
+			slots[j] = slot;
+		}
+	}
+
+	template <unsigned N, class K>
+	__attribute__((target("sse2")))
+	static void find_batch_sse2(const K* table, const K* keys, unsigned* slots, unsigned n) {
+		for (unsigned j = 0; j < n; ++j) {
+			const __m128i key = _mm_set1_epi32(static_cast<int>(keys[j]));
+			unsigned i = 0;
+			unsigned slot = N;
+			for (; i + 4 <= N && slot == N; i += 4) {
+				const __m128i block = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(table + i));
+				const int mask = _mm_movemask_ps(
+					_mm_castsi128_ps(_mm_cmpeq_epi32(block, key)));
+				slot = mask ? i + __builtin_ctz(mask) : N;
+			}
+			for (; i < N && slot == N; ++i) {
+				slot = (table[i] == keys[j]) ? i : N;
+			}
+			slots[j] = slot;
+		}
+	}
+	#endif
+	#endif
+
+	#ifndef DOXYGEN
+	//the other storage types interleave Width searches (group
+	//prefetching).  Every step of every search first prefetches what
+	//the following step could touch and then touches what the previous
+	//step prefetched, so Width cache misses are in flight at once.
+
+	//hash: hash all keys and fetch their displacements, then find all
+	//slots and fetch their keys and values, then compare
+	template <unsigned Width, unsigned N, class K, class V>
+	static void find_batch(const hash_map<N, K, V>& map, const K* keys, unsigned* slots, unsigned n) {
+		constexpr unsigned buckets = hash_map<N, K, V>::buckets;
+		std::uint64_t h[Width];
+		for (unsigned j = 0; j < n; j += Width) {
+			const unsigned m = (n - j < Width) ? n - j : Width;
+			for (unsigned g = 0; g < m; ++g) {
+				h[g] = static_hash<K>{}(keys[j + g], map.seed);
+				prefetch(map.disp + (h[g] >> 32) % buckets);
+			}
+			for (unsigned g = 0; g < m; ++g) {
+				slots[j + g] = phf_slot<N>(h[g], map.disp[(h[g] >> 32) % buckets]);
+				prefetch(map.keys + slots[j + g]);
+				prefetch(map.values + slots[j + g]);
+			}
+			for (unsigned g = 0; g < m; ++g) {
+				slots[j + g] = (map.keys[slots[j + g]] == keys[j + g]) ? slots[j + g] : N;
+			}
+		}
+	}
+
+	//the hashes with other layouts: as above, fetching the entries
+	//instead of the keys and values
+	template <unsigned Width, class Map, class K>
+	static void find_batch_entries(const Map& map, const K* keys, unsigned* slots, unsigned n) {
+		constexpr unsigned N = Map::length;
+		constexpr unsigned buckets = Map::buckets;
+		std::uint64_t h[Width];
+		for (unsigned j = 0; j < n; j += Width) {
+			const unsigned m = (n - j < Width) ? n - j : Width;
+			for (unsigned g = 0; g < m; ++g) {
+				h[g] = static_hash<K>{}(keys[j + g], map.seed);
+				prefetch(map.disp + (h[g] >> 32) % buckets);
+			}
+			for (unsigned g = 0; g < m; ++g) {
+				slots[j + g] = phf_slot<N>(h[g], map.disp[(h[g] >> 32) % buckets]);
+				prefetch(map.entries + slots[j + g]);
+			}
+			for (unsigned g = 0; g < m; ++g) {
+				slots[j + g] = (map.entries[slots[j + g]].key == keys[j + g]) ? slots[j + g] : N;
+			}
+		}
+	}
+
+	template <unsigned Width, unsigned N, class K, class V>
+	static void find_batch(const interleaved_hash_map<N, K, V>& map, const K* keys,
+		unsigned* slots, unsigned n)
+	{
+		find_batch_entries<Width>(map, keys, slots, n);
+	}
+
+	template <unsigned Width, unsigned N, class K, class V, class Hot>
+	static void find_batch(const hot_cold_hash_map<N, K, V, Hot>& map, const K* keys,
+		unsigned* slots, unsigned n)
+	{
+		find_batch_entries<Width>(map, keys, slots, n);
+	}
+
+	//sorted: branchless lower bound in lockstep.  All searches halve
+	//the same range length, so each step can prefetch both places the
+	//next step might probe.
+	template <unsigned Width, unsigned N, class K, class V>
+	static void find_batch(const sorted_map<N, K, V>& map, const K* keys, unsigned* slots, unsigned n) {
+		unsigned base[Width];
+		for (unsigned j = 0; j < n; j += Width) {
+			const unsigned m = (n - j < Width) ? n - j : Width;
+			for (unsigned g = 0; g < m; ++g) {
+				base[g] = 0;
+			}
+			for (unsigned len = N; len > 1; ) {
+				const unsigned half = len / 2;
+				const unsigned next = (len - half) / 2;
+				for (unsigned g = 0; g < m; ++g) {
+					prefetch(map.keys + base[g] + next);
+					prefetch(map.keys + base[g] + half + next);
+					base[g] = (map.keys[base[g] + half] < keys[j + g]) ? base[g] + half : base[g];
+				}
+				len -= half;
+			}
+			for (unsigned g = 0; g < m; ++g) {
+				const unsigned s = base[g] + (map.keys[base[g]] < keys[j + g]);
+				slots[j + g] = (s < N && map.keys[s] == keys[j + g]) ? s : N;
+			}
+		}
+	}
+
+	//eytzinger: descend all trees in lockstep.  Searches that already
+	//fell off the bottom (the last level is partial) stay put.
+	template <unsigned Width, unsigned N, class K, class V>
+	static void find_batch(const eytzinger_map<N, K, V>& map, const K* keys, unsigned* slots, unsigned n) {
+		constexpr unsigned per_line = eytzinger_map<N, K, V>::per_line;
+		unsigned depth = 0;
+		for (unsigned x = N; x != 0; x >>= 1) {
+			++depth;
+		}
+		unsigned k[Width];
+		for (unsigned j = 0; j < n; j += Width) {
+			const unsigned m = (n - j < Width) ? n - j : Width;
+			for (unsigned g = 0; g < m; ++g) {
+				k[g] = 1;
+			}
+			for (unsigned level = 0; level < depth; ++level) {
+				for (unsigned g = 0; g < m; ++g) {
+					prefetch(map.keys + ((k[g]*per_line <= N) ? k[g]*per_line - 1 : 0));
+					k[g] = (k[g] <= N) ? 2*k[g] + (map.keys[k[g] - 1] < keys[j + g]) : k[g];
+				}
+			}
+			for (unsigned g = 0; g < m; ++g) {
+				const unsigned x = last_left_turn(k[g]);
+				slots[j + g] = (x != 0 && map.keys[x - 1] == keys[j + g]) ? x - 1 : N;
+			}
+		}
+	}
+	#endif
+
+	/**
+	 * Copy table[indices[j]] to values[j] for several indices.
+	 *
+	 * This is the generic version, which copies one value at a time.
+	 *
+	 * \param table The table to read
+	 * \param indices The indices to read
+	 * \param values Receives the values
+	 * \param n The number of indices
+	 */
+	template <class V>
+	static typename std::enable_if<!simd_value<V>::value>::type
+	gather(const V* table, const unsigned* indices, V* values, unsigned n) {
+		for (unsigned j = 0; j < n; ++j) {
+			values[j] = table[indices[j]];
+		}
+	}
+
+	#ifndef DOXYGEN
+	//4 and 8 byte values can use the AVX2 gather instructions.  The
+	//indices are treated as signed, so tables must have < 2^31 entries.
+	template <class V>
+	static typename std::enable_if<simd_value<V>::value>::type
+	gather(const V* table, const unsigned* indices, V* values, unsigned n) {
+		unsigned j = 0;
+		#ifdef STATIC_TABLE_X86_SIMD
+		if (simd() == simd_avx2) {
+			j = gather_avx2(table, indices, values, n);
+		}
+		#endif
+		for (; j < n; ++j) {
+			values[j] = table[indices[j]];
+		}
+	}
+
+	#ifdef STATIC_TABLE_X86_SIMD
+	//returns how many values were gathered; the caller does the rest
+	template <class V>
+	__attribute__((target("avx2")))
+	static unsigned gather_avx2(const V* table, const unsigned* indices, V* values, unsigned n) {
+		unsigned j = 0;
+		if (sizeof(V) == 4) {
+			for (; j + 8 <= n; j += 8) {
+				const __m256i idx = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(indices + j));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + j),
+					_mm256_i32gather_epi32(
+						reinterpret_cast<const int*>(table), idx, 4));
+			}
+		}
+		else {
+			for (; j + 4 <= n; j += 4) {
+				const __m128i idx = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(indices + j));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + j),
+					_mm256_i32gather_epi64(
+						reinterpret_cast<const long long*>(table), idx, 8));
+			}
+		}
+		return j;
+	}
+	#endif
+	#endif
+
+	/**
+	 * The integer type that a packed_static_table value is stored as.
+	 *
+	 * This is V itself for integral types and the underlying type for
+	 * enumerations.
+	 */
+	template <class V, bool = std::is_enum<V>::value>
+	struct packed_int {
+		typedef V type;
+	};
+
+	#ifndef DOXYGEN
+	template <class V>
+	struct packed_int<V, true> {
+		typedef typename std::underlying_type<V>::type type;
+	};
+	#endif
+
+	/**
+	 * The frame of reference of a packed_static_table.
+	 */
+	struct packed_range {
+		///the smallest value, as an unsigned 64 bit integer
+		std::uint64_t min;
+		///how many bits it takes to store any value minus min
+		unsigned bits;
+	};
+
+	/**
+	 * Find the frame of reference for the values produced by func.
+	 *
+	 * Values are compared as their integer type, so signed values use
+	 * signed order.  The differences from the smallest value are
+	 * computed modulo 2^64, which is exact because they all fit in the
+	 * integer type.
+	 *
+	 * \param func The value generator
+	 * \return The smallest value and the bit width of the differences
+	 */
+	template <unsigned N, class V, class Fn>
+	static constexpr packed_range pack_range(Fn func) {
+		typedef typename packed_int<V>::type I;
+		I lo = static_cast<I>(func(0U));
+		I hi = lo;
+		for (unsigned i = 1; i < N; ++i) {
+			const I v = static_cast<I>(func(i));
+			lo = (v < lo) ? v : lo;
+			hi = (hi < v) ? v : hi;
+		}
+		packed_range r{ static_cast<std::uint64_t>(lo), 0 };
+		for (std::uint64_t span = static_cast<std::uint64_t>(hi) - r.min; span; span >>= 1) {
+			++r.bits;
+		}
+		return r;
+	}
+
+	/**
+	 * Read a bit field from an array of 64 bit words.
+	 *
+	 * The field may straddle two words.  The word after the field must
+	 * exist, even if the field does not reach it.
+	 *
+	 * \param words The packed array
+	 * \param off The bit offset of the field
+	 * \param mask The low bits set, one per bit in the field
+	 * \return The field
+	 */
+	static constexpr std::uint64_t unpack(const std::uint64_t* words,
+		std::uint64_t off, std::uint64_t mask)
+	{
+		const unsigned sh = off & 63;
+		//(x << 1) << (63 - sh) is x << (64 - sh), which would be
+		//undefined for sh == 0
+		return ((words[off >> 6] >> sh) |
+			((words[(off >> 6) + 1] << 1) << (63 - sh))) & mask;
+	}
+
+	#if defined(STATIC_TABLE_X86_SIMD) && !defined(DOXYGEN)
+	//decode 4 consecutive fields per step with unaligned 64 bit gathers
+	//at byte granularity, which needs bits <= 56 and a little-endian
+	//layout.  returns how many fields were decoded; the caller does the
+	//rest.
+	__attribute__((target("avx2")))
+	static unsigned unpack_avx2(const std::uint64_t* words, std::uint64_t off,
+		unsigned bits, std::uint64_t min, std::uint64_t* out, unsigned n)
+	{
+		const __m256i step = _mm256_set1_epi64x(4LL * bits);
+		const __m256i mask = _mm256_set1_epi64x((1LL << bits) - 1);
+		const __m256i base = _mm256_set1_epi64x(static_cast<long long>(min));
+		const __m256i seven = _mm256_set1_epi64x(7);
+		__m256i offs = _mm256_add_epi64(
+			_mm256_set1_epi64x(static_cast<long long>(off)),
+			_mm256_set_epi64x(3LL * bits, 2LL * bits, bits, 0));
+		const long long* bytes = reinterpret_cast<const long long*>(words);
+		unsigned j = 0;
+		for (; j + 4 <= n; j += 4) {
+			const __m256i raw = _mm256_i64gather_epi64(
+				bytes, _mm256_srli_epi64(offs, 3), 1);
+			const __m256i field = _mm256_and_si256(
+				_mm256_srlv_epi64(raw, _mm256_and_si256(offs, seven)), mask);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j),
+				_mm256_add_epi64(field, base));
+			offs = _mm256_add_epi64(offs, step);
+		}
+		return j;
+	}
+	#endif
+
+	/**
+	 * Count the set bits of a 64 bit integer.
+	 *
+	 * This is the usual SWAR sum, which is constexpr everywhere.  GCC
+	 * and Clang recognize it and emit a popcnt instruction when the
+	 * target has one (-mpopcnt, -msse4.2 or -march=native).
+	 *
+	 * \param x The integer
+	 * \return The number of bits set in x
+	 */
+	static constexpr unsigned popcount64(std::uint64_t x) {
+		x = x - ((x >> 1) & 0x5555555555555555ULL);
+		x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return static_cast<unsigned>((x * 0x0101010101010101ULL) >> 56);
+	}
+
+	/**
+	 * 512 bits of a sparse_static_map's bitmap and their rank directory.
+	 *
+	 * The directory sits in front of the bits it counts, so a rank
+	 * usually touches one cache line.  It costs 128 bits per 512, which
+	 * makes the whole bitmap 1.25 bits per slot of the key range.
+	 */
+	struct rank_block {
+		///the number of bits set before this block
+		std::uint64_t base;
+		///the number of bits set in this block before word k, for k in
+		///[1, 8), as 9 bit fields starting at bit 9*(k - 1)
+		std::uint64_t counts;
+		///the bits, lowest slot first
+		std::uint64_t words[8];
+	};
+
+	/**
+	 * Count the bits set before a slot of a rank_block bitmap.
+	 *
+	 * \param blocks The bitmap
+	 * \param d The slot
+	 * \return The number of bits set in [0, d)
+	 */
+	static constexpr unsigned rank(const rank_block* blocks, std::uint64_t d) {
+		const rank_block& b = blocks[d >> 9];
+		const unsigned k = (d >> 6) & 7;
+		return static_cast<unsigned>(b.base) +
+			(k ? static_cast<unsigned>(b.counts >> (9 * k - 9)) & 0x1FF : 0) +
+			popcount64(b.words[k] & ((std::uint64_t{1} << (d & 63)) - 1));
+	}
+
+	/**
+	 * Find the slot of the ith set bit of a rank_block bitmap.
+	 *
+	 * This binary searches the blocks, then steps through one block's
+	 * words and bits, so it is O(lg(blocks)).
+	 *
+	 * \param blocks The bitmap
+	 * \param n The number of blocks
+	 * \param i The rank, less than the number of bits set
+	 * \return The slot whose bit is the ith one set
+	 */
+	static constexpr std::uint64_t select(const rank_block* blocks, unsigned n, unsigned i) {
+		//the last block that starts at or before rank i
+		unsigned lo = 0;
+		while (n > 1) {
+			const unsigned half = n / 2;
+			lo = (blocks[lo + half].base <= i) ? lo + half : lo;
+			n -= half;
+		}
+		const rank_block& b = blocks[lo];
+		unsigned left = i - static_cast<unsigned>(b.base);
+		unsigned k = 0;
+		while (k < 7 && ((b.counts >> (9 * k)) & 0x1FF) <= left) {
+			++k;
+		}
+		left -= k ? static_cast<unsigned>(b.counts >> (9 * k - 9)) & 0x1FF : 0;
+		std::uint64_t w = b.words[k];
+		for (; left; --left) {
+			w &= w - 1;
+		}
+		//the position of the lowest bit left
+		return std::uint64_t{lo} * 512 + k * 64 + popcount64((w & (~w + 1)) - 1);
+	}
+
+	/**
+	 * The key range of a sparse_static_map.
+	 */
+	struct sparse_range {
+		///the smallest key, as an unsigned 64 bit integer
+		std::uint64_t min;
+		///the largest key minus the smallest
+		std::uint64_t span;
+	};
+
+	/**
+	 * Find the key range of the keys produced by keygen.
+	 *
+	 * Keys are compared as their integer type (see pack_range()).
+	 *
+	 * \param keygen The key generator
+	 * \return The smallest key and the distance to the largest
+	 */
+	template <unsigned N, class K, class KeyGen>
+	static constexpr sparse_range sparse_build(KeyGen keygen) {
+		typedef typename packed_int<K>::type I;
+		I lo = static_cast<I>(keygen(0U));
+		I hi = lo;
+		for (unsigned i = 1; i < N; ++i) {
+			const I k = static_cast<I>(keygen(i));
+			lo = (k < lo) ? k : lo;
+			hi = (hi < k) ? k : hi;
+		}
+		return { static_cast<std::uint64_t>(lo),
+			static_cast<std::uint64_t>(hi) - static_cast<std::uint64_t>(lo) };
+	}
+
+	/**
+	 * Evaluate a Catmull-Rom spline.
+	 *
+	 * The operations are in the same order as in interpolate_avx2(), so
+	 * the results are identical.
+	 *
+	 * \param p0 The sample before the interval
+	 * \param p1 The sample at the start of the interval
+	 * \param p2 The sample at the end of the interval
+	 * \param p3 The sample after the interval
+	 * \param t The position in the interval, in [0, 1]
+	 * \return The spline at t
+	 */
+	template <class V>
+	static constexpr V catmull_rom(V p0, V p1, V p2, V p3, V t) {
+		return p1 + V(0.5) * t * ((p2 - p0) + t * (((p0 + p0) - V(5) * p1 +
+			V(4) * p2 - p3) + t * (V(3) * (p1 - p2) + p3 - p0)));
+	}
+
+	#if defined(STATIC_TABLE_X86_SIMD) && !defined(DOXYGEN)
+	//a 4-wide gather of doubles.  The masked form with an explicit
+	//source keeps GCC from warning that the unmasked one reads an
+	//uninitialized register.
+	__attribute__((target("avx2")))
+	static __m256d gather_pd(const double* base, __m128i index) {
+		return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, index,
+			_mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+	}
+
+	//evaluate 4 points per step of an interpolated_table of doubles.
+	//samples has one padding sample before the first and after the
+	//last.  returns how many points were evaluated; the caller does the
+	//rest.
+	template <unsigned Order>
+	__attribute__((target("avx2")))
+	static unsigned interpolate_avx2(const double* samples, double last,
+		double lo, double scale, const double* xs, double* ys, unsigned n)
+	{
+		const __m256d origin = _mm256_set1_pd(lo);
+		const __m256d step = _mm256_set1_pd(scale);
+		const __m256d top = _mm256_set1_pd(last);
+		const __m256d inner = _mm256_set1_pd(last - 1);
+		const __m256d zero = _mm256_setzero_pd();
+		const __m256d half = _mm256_set1_pd(0.5);
+		unsigned j = 0;
+		for (; j + 4 <= n; j += 4) {
+			__m256d u = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(xs + j), origin), step);
+			u = _mm256_min_pd(_mm256_max_pd(u, zero), top);
+			__m256d y;
+			if (Order == 0) {
+				const __m128i i = _mm256_cvttpd_epi32(_mm256_add_pd(u, half));
+				y = gather_pd(samples + 1, i);
+			}
+			else {
+				const __m256d fi = _mm256_min_pd(_mm256_floor_pd(u), inner);
+				const __m256d t = _mm256_sub_pd(u, fi);
+				const __m128i i = _mm256_cvttpd_epi32(fi);
+				const __m256d p1 = gather_pd(samples + 1, i);
+				const __m256d p2 = gather_pd(samples + 2, i);
+				if (Order == 1) {
+					y = _mm256_add_pd(p1, _mm256_mul_pd(t, _mm256_sub_pd(p2, p1)));
+				}
+				else {
+					const __m256d p0 = gather_pd(samples, i);
+					const __m256d p3 = gather_pd(samples + 3, i);
+					const __m256d a = _mm256_sub_pd(p2, p0);
+					const __m256d b = _mm256_sub_pd(_mm256_add_pd(_mm256_sub_pd(
+						_mm256_add_pd(p0, p0), _mm256_mul_pd(_mm256_set1_pd(5), p1)),
+						_mm256_mul_pd(_mm256_set1_pd(4), p2)), p3);
+					const __m256d c = _mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(
+						_mm256_set1_pd(3), _mm256_sub_pd(p1, p2)), p3), p0);
+					const __m256d poly = _mm256_add_pd(a, _mm256_mul_pd(t,
+						_mm256_add_pd(b, _mm256_mul_pd(t, c))));
+					y = _mm256_add_pd(p1, _mm256_mul_pd(_mm256_mul_pd(half, t), poly));
+				}
+			}
+			_mm256_storeu_pd(ys + j, y);
+		}
+		return j;
+	}
+	#endif
+
+	///the extent of a grid dimension once padded for a row-major layout
+	static constexpr unsigned grid_padded(unsigned d, static_layout::row_major) {
+		return d;
+	}
+
+	///the extent of a grid dimension once padded to whole tiles
+	template <unsigned Tile>
+	static constexpr unsigned grid_padded(unsigned d, static_layout::tiled<Tile>) {
+		return (d + Tile - 1) / Tile * Tile;
+	}
+
+	///the extent of a grid dimension once padded to a power of two
+	static constexpr unsigned grid_padded(unsigned d, static_layout::morton) {
+		unsigned p = 1;
+		while (p < d) {
+			p *= 2;
+		}
+		return p;
+	}
+
+	///the product of some extents
+	template <class... Ts>
+	static constexpr unsigned grid_product(Ts... ds) {
+		const unsigned a[] = { 1U, static_cast<unsigned>(ds)... };
+		unsigned r = 1;
+		for (unsigned x : a) {
+			r *= x;
+		}
+		return r;
+	}
+
+	///the sum of some extents
+	template <class... Ts>
+	static constexpr unsigned grid_sum(Ts... ds) {
+		const unsigned a[] = { 0U, static_cast<unsigned>(ds)... };
+		unsigned r = 0;
+		for (unsigned x : a) {
+			r += x;
+		}
+		return r;
+	}
+
+	/**
+	 * Compute the offset that each index of each dimension contributes.
+	 *
+	 * Every static_layout is separable: the storage offset of a cell is
+	 * the sum over the dimensions of spread[first[k] + index[k]].
+	 *
+	 * \param d The D extents
+	 * \param D The number of dimensions
+	 * \param first The start of each dimension in spread
+	 * \param spread Receives the contributions
+	 */
+	template <class Spread>
+	static constexpr void grid_spread(const unsigned* d, unsigned D,
+		const unsigned* first, Spread& spread, static_layout::row_major)
+	{
+		unsigned stride = 1;
+		for (unsigned k = D; k-- > 0;) {
+			for (unsigned i = 0; i < d[k]; ++i) {
+				spread[first[k] + i] = i * stride;
+			}
+			stride *= d[k];
+		}
+	}
+
+	#ifndef DOXYGEN
+	template <class Spread, unsigned Tile>
+	static constexpr void grid_spread(const unsigned* d, unsigned D,
+		const unsigned* first, Spread& spread, static_layout::tiled<Tile>)
+	{
+		//tiles are Tile^D cells, in row-major order of the tile grid
+		unsigned block = 1;
+		for (unsigned k = 0; k < D; ++k) {
+			block *= Tile;
+		}
+		unsigned outer = block;
+		unsigned inner = 1;
+		for (unsigned k = D; k-- > 0;) {
+			for (unsigned i = 0; i < d[k]; ++i) {
+				spread[first[k] + i] = (i / Tile) * outer + (i % Tile) * inner;
+			}
+			outer *= grid_padded(d[k], static_layout::tiled<Tile>()) / Tile;
+			inner *= Tile;
+		}
+	}
+
+	template <class Spread>
+	static constexpr void grid_spread(const unsigned* d, unsigned D,
+		const unsigned* first, Spread& spread, static_layout::morton)
+	{
+		for (unsigned k = 0; k < D; ++k) {
+			for (unsigned i = 0; i < d[k]; ++i) {
+				spread[first[k] + i] = 0;
+			}
+		}
+		//deal out the bits a level at a time, last dimension lowest;
+		//dimensions with fewer bits drop out, so nothing is wasted
+		unsigned next = 0;
+		for (unsigned level = 0; level < 32; ++level) {
+			for (unsigned k = D; k-- > 0;) {
+				if ((1ULL << level) < grid_padded(d[k], static_layout::morton())) {
+					for (unsigned i = 0; i < d[k]; ++i) {
+						spread[first[k] + i] |= ((i >> level) & 1U) << next;
+					}
+					++next;
+				}
+			}
+		}
+	}
+	#endif
+
+	/**
+	 * Raise a number to a non-negative integer power by squaring.
+	 */
+	static constexpr double ipow(double x, std::uint64_t n) {
+		double r = 1;
+		for (; n; n >>= 1) {
+			r = (n & 1) ? r * x : r;
+			x *= x;
+		}
+		return r;
+	}
+
+	/**
+	 * Estimate the false positive rate of a bloom_filter.
+	 *
+	 * This treats the bits of a word as independent: a word with j
+	 * keys has about 1 - (63/64)^(j*k) of its bits set, and a missing
+	 * key passes with that to the power k.  That is a little low, since
+	 * the bits cluster, but it is cheap enough to try every k with.
+	 *
+	 * \param n The number of keys
+	 * \param words The number of 64 bit words
+	 * \param k The number of bits set per key
+	 * \return About the probability that a missing key passes
+	 */
+	static constexpr double bloom_estimate(unsigned n, unsigned words, unsigned k) {
+		if (words == 1) {
+			return ipow(1 - ipow(63.0 / 64, std::uint64_t{n} * k), k);
+		}
+		const double p = 1.0 / words;
+		const double lambda = double(n) * p;
+		double term = ipow(1 - p, n);
+		double r = 0;
+		for (unsigned j = 0; j <= n; ++j) {
+			if (j != 0) {
+				term *= double(n - j + 1) / j * p / (1 - p);
+			}
+			r += term * ipow(1 - ipow(63.0 / 64, std::uint64_t{j} * k), k);
+			if (j > lambda && term < 1e-16) {
+				break;
+			}
+		}
+		return r;
+	}
+
+	/**
+	 * Compute the false positive rate of a bloom_filter.
+	 *
+	 * The keys land in the words binomially, and each key sets k
+	 * uniformly random bits of its word.  For each number of keys j in
+	 * a word, the distribution of the number of bits set is tracked
+	 * bit by bit, and a missing key passes if all k of its bits are
+	 * among them.
+	 *
+	 * \param n The number of keys
+	 * \param words The number of 64 bit words
+	 * \param k The number of bits set per key
+	 * \return The probability that a missing key passes
+	 */
+	static constexpr double bloom_fpr(unsigned n, unsigned words, unsigned k) {
+		const double p = 1.0 / words;
+		const double lambda = double(n) * p;
+		//term is the probability that a word holds j keys
+		double term = (words == 1) ? 0 : ipow(1 - p, n);
+		//set[b] is the probability that b bits are set after j keys
+		double set[65] = { 1 };
+		double r = 0;
+		for (unsigned j = 0; j <= n; ++j) {
+			if (j != 0) {
+				term = (words == 1) ? (j == n) :
+					term * (double(n - j + 1) / j * p / (1 - p));
+				for (unsigned h = 0; h < k; ++h) {
+					for (unsigned b = 64; b > 0; --b) {
+						set[b] = set[b] * (b / 64.0) + set[b - 1] * ((65 - b) / 64.0);
+					}
+					set[0] = 0;
+				}
+			}
+			double pass = 0;
+			for (unsigned b = 1; b <= 64; ++b) {
+				pass += set[b] * ipow(b / 64.0, k);
+			}
+			r += term * pass;
+			if (j > lambda && term < 1e-16) {
+				break;
+			}
+		}
+		return r;
+	}
+
+	/**
+	 * The size of a bloom_filter.
+	 */
+	struct bloom_layout {
+		///the number of 64 bit words
+		unsigned words;
+		///the number of bits set per key
+		unsigned hashes;
+		///the estimated false positive rate
+		double fpr;
+	};
+
+	///the largest number of bits a bloom_filter sets per key
+	static constexpr unsigned bloom_max_hashes = 8;
+
+	/**
+	 * Find the smallest bloom_filter for n keys that lets at most 1 in
+	 * one_in missing keys through.
+	 *
+	 * Sizes are tried a bit per key at a time, up to 64 bits per key.
+	 * For each, the best number of bits per key up to bloom_max_hashes
+	 * is picked with bloom_estimate(), and once that meets the target
+	 * it is checked with bloom_fpr().
+	 *
+	 * \param n The number of keys
+	 * \param one_in The inverse of the target false positive rate
+	 * \return The layout, whose fpr is above the target if there is
+	 * none small enough
+	 */
+	static constexpr bloom_layout bloom_size(unsigned n, unsigned one_in) {
+		bloom_layout r{ 1, 1, 1 };
+		for (unsigned bits = 1; bits <= 64; ++bits) {
+			const unsigned words = static_cast<unsigned>((std::uint64_t{n} * bits + 63) / 64);
+			r = { words, 1, bloom_estimate(n, words, 1) };
+			for (unsigned k = 2; k <= bloom_max_hashes; ++k) {
+				const double fpr = bloom_estimate(n, words, k);
+				r = (fpr < r.fpr) ? bloom_layout{ words, k, fpr } : r;
+			}
+			if (r.fpr * one_in <= 1) {
+				r.fpr = bloom_fpr(n, words, r.hashes);
+				if (r.fpr * one_in <= 1) {
+					return r;
+				}
+			}
+		}
+		return r;
+	}
+
+	/**
+	 * A register-blocked Bloom filter over N keys.
+	 *
+	 * Each key sets Layout.hashes bits in a single 64 bit word, so a
+	 * test is one hash, one load and one compare.  That costs a higher
+	 * false positive rate per bit than a classic Bloom filter, which
+	 * bloom_size() makes up for with a few more bits.
+	 *
+	 * \tparam N The number of keys
+	 * \tparam K The key type
+	 * \tparam OneIn The inverse of the target false positive rate
+	 */
+	template <unsigned N, class K, unsigned OneIn>
+	struct bloom_filter {
+		///the size of the filter
+		static constexpr bloom_layout layout = bloom_size(N, OneIn);
+		static_assert(layout.fpr * OneIn <= 1, "static_filter::bloom cannot "
+			"reach that false positive rate");
+
+		///the estimated false positive rate
+		static constexpr double fpr = layout.fpr;
+		///the size of the filter in bytes
+		static constexpr std::size_t bytes = layout.words * sizeof(std::uint64_t);
+
+		///the bits
+		std::uint64_t words[layout.words];
+
+		///the word a hash tests: the high half scaled to [0, words)
+		static constexpr unsigned word_of(std::uint64_t h) {
+			return static_cast<unsigned>(((h >> 32) * layout.words) >> 32);
+		}
+
+		///the jth bit a hash tests, if j < layout.hashes
+		static constexpr std::uint64_t bit_of(std::uint64_t x, unsigned j) {
+			return (j < layout.hashes) ?
+				std::uint64_t{1} << ((x >> (58 - 6 * j)) & 63) : 0;
+		}
+
+		///the bits a hash tests: 6 bit positions from the top of the
+		///low half times the golden ratio.  This is written out rather
+		///than looped so that the shifts run in parallel; a loop is
+		///not unrolled at -O2 and takes twice as long.
+		static constexpr std::uint64_t mask_of(std::uint64_t h) {
+			const std::uint64_t x = (h & 0xFFFFFFFFULL) * 0x9E3779B97F4A7C15ULL;
+			static_assert(bloom_max_hashes == 8, "mask_of() sets up to 8 bits");
+			return bit_of(x, 0) | bit_of(x, 1) | bit_of(x, 2) | bit_of(x, 3) |
+				bit_of(x, 4) | bit_of(x, 5) | bit_of(x, 6) | bit_of(x, 7);
+		}
+
+		///hash a key; the seed keeps this independent of phf_build()
+		static constexpr std::uint64_t hash(K key) {
+			return static_hash<K>()(key, 0x6A09E667F3BCC909ULL);
+		}
+
+		///build the filter from the key generator
+		template <class KeyGen>
+		static constexpr bloom_filter build(KeyGen keygen) {
+			bloom_filter r{};
+			for (unsigned i = 0; i < N; ++i) {
+				const std::uint64_t h = hash(keygen(i));
+				r.words[word_of(h)] |= mask_of(h);
+			}
+			return r;
+		}
+
+		///false if key is certainly not one of the keys
+		constexpr bool may_contain(K key) const {
+			const std::uint64_t h = hash(key);
+			const std::uint64_t m = mask_of(h);
+			return (words[word_of(h)] & m) == m;
+		}
+	};
+
+	/**
+	 * The filter of a static_map without one.
+	 */
+	struct no_filter {
+		///every key passes
+		static constexpr double fpr = 1;
+		///the filter takes no space
+		static constexpr std::size_t bytes = 0;
+
+		///build the filter (there is nothing to build)
+		template <class KeyGen>
+		static constexpr no_filter build(KeyGen) {
+			return {};
+		}
+
+		///always true
+		template <class K>
+		constexpr bool may_contain(K) const {
+			return true;
+		}
+	};
+
+	///reads the value of the ith generated entry of a built map, as a
+	///key generator for sort_build()
+	template <class Map>
+	struct generated_values {
+		const Map* map;
+		constexpr decltype(map->values[0]) operator()(unsigned i) {
+			return map->values[map->slot(i)];
+		}
+	};
+
+	/**
+	 * A reverse index that is binary searched by value.
+	 *
+	 * slots lists the slots of the map's entries in order of value.
+	 * The sort is stable, so the entries of equal values are in
+	 * generator order.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class V>
+	struct sorted_reverse {
+		///slots[r] is the slot of the entry with the rth smallest value
+		unsigned slots[N];
+
+		///build the index for a built map
+		template <class Map>
+		static constexpr sorted_reverse build(const Map& map) {
+			const permutation<N> p = sort_build<N>(generated_values<Map>{ &map });
+			sorted_reverse r{};
+			for (unsigned i = 0; i < N; ++i) {
+				r.slots[i] = map.slot(p.order[i]);
+			}
+			return r;
+		}
+
+		/**
+		 * Find the entries whose value is v.
+		 *
+		 * \param values The values of the map, in slot order
+		 * \param v The value to search for
+		 * \return The range [first, second) of positions in slots, empty
+		 * if no entry has value v
+		 */
+		constexpr std::pair<unsigned, unsigned> range(const V* values, const V& v) const {
+			unsigned lo = 0;
+			unsigned hi = N;
+			while (lo < hi) {
+				const unsigned mid = midpoint(lo, hi);
+				if (values[slots[mid]] < v) {
+					lo = mid + 1;
+				}
+				else {
+					hi = mid;
+				}
+			}
+			//the caller visits the equal values anyway, so step over them
+			unsigned end = lo;
+			while (end != N && !(v < values[slots[end]])) {
+				++end;
+			}
+			return std::pair<unsigned, unsigned>(lo, end);
+		}
+	};
+
+	/**
+	 * A reverse index that hashes values into buckets.
+	 *
+	 * There are at least as many buckets as entries, a power of 2.
+	 * slots lists the slots of the map's entries bucket by bucket, and
+	 * within a bucket the entries of equal values are next to each
+	 * other, in generator order.  A lookup hashes the value and scans
+	 * its bucket, which holds about one entry.
+	 *
+	 * \tparam N The number of entries
+	 * \tparam V The value type
+	 */
+	template <unsigned N, class V>
+	struct hashed_reverse {
+		///the number of buckets, the smallest power of 2 that is at
+		///least N
+		static constexpr unsigned buckets = 1U << search_depth(N - 1);
+		///the seed passed to static_hash
+		static constexpr std::uint64_t seed = 0xBB67AE8584CAA73BULL;
+		///bucket b holds slots[start[b]] ... slots[start[b+1]-1]
+		unsigned start[buckets + 1];
+		///the slots of the entries, grouped by bucket then by value
+		unsigned slots[N];
+
+		///the bucket of a value
+		static constexpr unsigned bucket_of(const V& v) {
+			return static_cast<unsigned>(static_hash<V>{}(v, seed) >> 32) & (buckets - 1);
+		}
+
+		///build the index for a built map
+		template <class Map>
+		static constexpr hashed_reverse build(const Map& map) {
+			hashed_reverse r{};
+			unsigned count[buckets] = {};
+			for (unsigned i = 0; i < N; ++i) {
+				++r.start[bucket_of(map.values[map.slot(i)]) + 1];
+			}
+			for (unsigned b = 0; b < buckets; ++b) {
+				r.start[b + 1] += r.start[b];
+			}
+			for (unsigned i = 0; i < N; ++i) {
+				const unsigned b = bucket_of(map.values[map.slot(i)]);
+				r.slots[r.start[b] + count[b]++] = map.slot(i);
+			}
+			//gather the equals of each entry right behind it, keeping
+			//the rest in order
+			for (unsigned b = 0; b < buckets; ++b) {
+				unsigned x = r.start[b];
+				while (x < r.start[b + 1]) {
+					unsigned end = x + 1;
+					for (unsigned y = x + 1; y < r.start[b + 1]; ++y) {
+						if (map.values[r.slots[y]] == map.values[r.slots[x]]) {
+							const unsigned moved = r.slots[y];
+							for (unsigned z = y; z > end; --z) {
+								r.slots[z] = r.slots[z - 1];
+							}
+							r.slots[end++] = moved;
+						}
+					}
+					x = end;
+				}
+			}
+			return r;
+		}
+
+		///find the entries whose value is v (see sorted_reverse::range())
+		constexpr std::pair<unsigned, unsigned> range(const V* values, const V& v) const {
+			const unsigned b = bucket_of(v);
+			unsigned first = start[b];
+			while (first != start[b + 1] && !(values[slots[first]] == v)) {
+				++first;
+			}
+			unsigned end = first;
+			while (end != start[b + 1] && values[slots[end]] == v) {
+				++end;
+			}
+			return std::pair<unsigned, unsigned>(first, end);
+		}
+	};
+
+	///the reverse index of a map without one
+	struct no_reverse {
+		///there is no index to build
+		template <class Map>
+		static constexpr no_reverse build(const Map&) {
+			return {};
+		}
+	};
+
+	///the smallest sorted map that static_search::automatic lays out
+	///in Eytzinger order
+	static constexpr unsigned eytzinger_min = 4096;
+
+	/**
+	 * Picks the storage type for a static_map.
+	 *
+	 * \tparam Search The static_search tag requested by the user
+	 * \tparam Sorted If the keys are sorted
+	 * \tparam Hashed If a perfect hash could be built for the keys
+	 * \tparam Affine If the keys are integers in arithmetic progression
+	 * \tparam Sortable If the keys are unique and can be sorted
+	 */
+	template <class Search, bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage {
+		static_assert(std::is_same<Search, static_search::automatic>::value,
+			"Unknown static_search strategy");
+		typedef typename std::conditional<Affine, affine_map<N, K, V>,
+			typename std::conditional<Sorted,
+				typename std::conditional<(N >= eytzinger_min),
+					eytzinger_map<N, K, V>,
+					sorted_map<N, K, V>
+				>::type,
+				typename std::conditional<Hashed, hash_map<N, K, V>,
+					typename std::conditional<Sortable, permuted_map<N, K, V>,
+						linear_map<N, K, V>
+					>::type
+				>::type
+			>::type
+		>::type type;
+	};
+
+	#ifndef DOXYGEN
+	template <bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::linear, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		typedef linear_map<N, K, V> type;
+	};
+
+	template <bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::binary, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		static_assert(Sorted, "static_search::binary requires sorted keys");
+		typedef sorted_map<N, K, V> type;
+	};
+
+	template <bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::sort, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		static_assert(Sortable, "static_search::sort requires unique keys "
+			"that can be compared with <");
+		typedef permuted_map<N, K, V> type;
+	};
+
+	template <bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::direct, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		static_assert(Affine, "static_search::direct requires integral or "
+			"enumeration keys in arithmetic progression");
+		typedef affine_map<N, K, V> type;
+	};
+
+	template <bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::eytzinger, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		static_assert(Sorted, "static_search::eytzinger requires sorted keys");
+		typedef eytzinger_map<N, K, V> type;
+	};
+
+	template <bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::perfect_hash, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		static_assert(Hashed, "static_search::perfect_hash requires unique "
+			"keys that static_hash can hash");
+		typedef hash_map<N, K, V> type;
+	};
+
+	template <bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::interpolation, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		static_assert(Sorted, "static_search::interpolation requires sorted keys");
+		typedef learned_map<N, K, V> type;
+	};
+
+	template <class Profile, bool Sorted, bool Hashed, bool Affine, bool Sortable, unsigned N, class K, class V>
+	struct map_storage<static_search::profiled<Profile>, Sorted, Hashed, Affine, Sortable, N, K, V> {
+		typedef profiled_map<N, K, V, Profile> type;
+	};
+	#endif
+
+	/**
+	 * Picks the filter type for a static_map.
+	 *
+	 * \tparam Filter The static_filter tag requested by the user
+	 * \tparam Hashable If the keys can be hashed with static_hash
+	 */
+	template <class Filter, bool Hashable, unsigned N, class K>
+	struct map_filter {
+		static_assert(std::is_same<Filter, static_filter::none>::value,
+			"Unknown static_filter");
+		typedef no_filter type;
+	};
+
+	#ifndef DOXYGEN
+	template <unsigned OneIn, bool Hashable, unsigned N, class K>
+	struct map_filter<static_filter::bloom<OneIn>, Hashable, N, K> {
+		static_assert(Hashable, "static_filter::bloom requires keys that "
+			"static_hash can hash");
+		static_assert(OneIn > 1, "static_filter::bloom needs OneIn > 1");
+		typedef bloom_filter<N, K, OneIn> type;
+	};
+	#endif
+
+	/**
+	 * Picks the reverse index type for a static_map.
+	 *
+	 * \tparam Reverse The static_reverse tag requested by the user
+	 * \tparam Comparable If the values can be compared with <
+	 * \tparam Hashable If the values can be hashed with static_hash
+	 */
+	template <class Reverse, bool Comparable, bool Hashable, unsigned N, class V>
+	struct map_reverse {
+		static_assert(std::is_same<Reverse, static_reverse::none>::value,
+			"Unknown static_reverse");
+		typedef no_reverse type;
+	};
+
+	#ifndef DOXYGEN
+	template <bool Comparable, bool Hashable, unsigned N, class V>
+	struct map_reverse<static_reverse::sorted, Comparable, Hashable, N, V> {
+		static_assert(Comparable, "static_reverse::sorted requires values "
+			"that can be compared with <");
+		typedef sorted_reverse<N, V> type;
+	};
+
+	template <bool Comparable, bool Hashable, unsigned N, class V>
+	struct map_reverse<static_reverse::hashed, Comparable, Hashable, N, V> {
+		static_assert(Hashable, "static_reverse::hashed requires values "
+			"that static_hash can hash");
+		typedef hashed_reverse<N, V> type;
+	};
+	#endif
+
+	/**
+	 * Picks the storage layout for a static_map.
+	 *
+	 * \tparam Storage The static_storage tag requested by the user
+	 * \tparam Map The storage type that the search strategy picked
+	 */
+	template <class Storage, class Map>
+	struct map_layout {
+		static_assert(std::is_same<Storage, static_storage::separate>::value,
+			"static_storage::interleaved and hot_cold need a perfectly hashed map");
+		typedef Map type;
+	};
+
+	#ifndef DOXYGEN
+	template <unsigned N, class K, class V>
+	struct map_layout<static_storage::interleaved, hash_map<N, K, V>> {
+		typedef interleaved_hash_map<N, K, V> type;
+	};
+
+	template <class Hot, unsigned N, class K, class V>
+	struct map_layout<static_storage::hot_cold<Hot>, hash_map<N, K, V>> {
+		typedef hot_cold_hash_map<N, K, V, Hot> type;
+	};
+	#endif
+};
+
+/**
+ * A read-only view of a static_map's keys or values in sorted order.
+ *
+ * The view refers to the map's own arrays, so nothing is copied.  If
+ * the map stores its entries in sorted order, the view is contiguous
+ * and data() points at them; otherwise each element is found through
+ * the map's permutation.
+ *
+ * \tparam T The type of the elements
+ */
+template <class T>
+class static_view {
+public:
+	///The type of the elements
+	typedef T value_type;
+	///The type of a position in the view
+	typedef unsigned size_type;
+
+	/**
+	 * A random access iterator over a static_view.
+	 *
+	 * It points into the map, like the view, so it stays valid after
+	 * the view it came from is destroyed.
+	 */
+	class const_iterator {
+	public:
+		#ifndef NO_STDLIB
+		typedef std::random_access_iterator_tag iterator_category;
+		#endif
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
+		constexpr const_iterator() : elements(nullptr), slots(nullptr), i(0) {}
+		constexpr const_iterator(const T* d, const unsigned* s, unsigned pos) :
+			elements(d), slots(s), i(pos) {}
+
+		constexpr reference operator*() const { return at(i); }
+		constexpr pointer operator->() const { return &at(i); }
+		constexpr reference operator[](difference_type n) const { return at(i + n); }
+		///the position of this iterator in the view
+		constexpr unsigned index() const { return i; }
+
+		constexpr const_iterator& operator++() { ++i; return *this; }
+		constexpr const_iterator& operator--() { --i; return *this; }
+		constexpr const_iterator operator++(int) { const_iterator r = *this; ++i; return r; }
+		constexpr const_iterator operator--(int) { const_iterator r = *this; --i; return r; }
+		constexpr const_iterator& operator+=(difference_type n) { i += n; return *this; }
+		constexpr const_iterator& operator-=(difference_type n) { i -= n; return *this; }
+		constexpr const_iterator operator+(difference_type n) const {
+			return const_iterator(elements, slots, i + n);
+		}
+		constexpr const_iterator operator-(difference_type n) const {
+			return const_iterator(elements, slots, i - n);
+		}
+		friend constexpr const_iterator operator+(difference_type n, const_iterator it) { return it + n; }
+		constexpr difference_type operator-(const_iterator o) const {
+			return static_cast<difference_type>(i) - static_cast<difference_type>(o.i);
+		}
+
+		constexpr bool operator==(const_iterator o) const { return i == o.i; }
+		constexpr bool operator!=(const_iterator o) const { return i != o.i; }
+		constexpr bool operator<(const_iterator o) const { return i < o.i; }
+		constexpr bool operator>(const_iterator o) const { return i > o.i; }
+		constexpr bool operator<=(const_iterator o) const { return i <= o.i; }
+		constexpr bool operator>=(const_iterator o) const { return i >= o.i; }
+	private:
+		constexpr reference at(unsigned k) const {
+			return slots ? elements[slots[k]] : elements[k];
+		}
+
+		const T* elements;
+		const unsigned* slots;
+		unsigned i;
+	};
+	///views are read-only
+	typedef const_iterator iterator;
+
+	/**
+	 * Construct a view
+	 *
+	 * \param d The stored elements
+	 * \param s s[i] is the index in d of the ith element, or null for
+	 * the identity
+	 * \param n The number of elements
+	 */
+	constexpr static_view(const T* d, const unsigned* s, unsigned n) :
+		elements(d), slots(s), length(n)
+	{
+		//
+	}
+
+	///the ith element in sorted order (not bounds checked)
+	constexpr const T& operator[](unsigned i) const {
+		return slots ? elements[slots[i]] : elements[i];
+	}
+
+	///the number of elements
+	constexpr unsigned size() const {
+		return length;
+	}
+
+	///whether the elements are stored contiguously in sorted order
+	constexpr bool contiguous() const {
+		return slots == nullptr;
+	}
+
+	///the elements, if contiguous(), and null otherwise
+	constexpr const T* data() const {
+		return slots ? nullptr : elements;
+	}
+
+	constexpr const_iterator begin() const { return const_iterator(elements, slots, 0); }
+	constexpr const_iterator end() const { return const_iterator(elements, slots, length); }
+	constexpr const T& front() const { return (*this)[0]; }
+	constexpr const T& back() const { return (*this)[length - 1]; }
+private:
+	const T* elements;
+	const unsigned* slots;
+	unsigned length;
+};
+
+/**
+ * A statically initialized lookup map.
+ * 
+ * The KeyGen type must be able to map an unsigned index in the range
+ * [0, N) to a key.  The Fn type then maps the output of the KeyGen type
+ * to values.  Values can be looked up by key or by index.
+ * 
+ * Calling an object of type KeyGen or Fn MUST be a constexpr operation.
+ * To use the default constructor, KeyGen and Fn MUST be constexpr
+ * default constructable function objects.  
+ * 
+ * To use regular functions, see the global function generate_static_map().
+ * 
+ * To illustrate:
+ * 
+ * \code{.cpp}
+ * 
+ * //An example of types that would be valid:
+ * template <typename key_type, typename value_type>
+ * struct static_map_functs {
+ *     struct KeyGen {
+ *         constexpr key_type operator()(unsigned);
+ *     };
+ *     struct Fn {
+ *         constexpr value_type operator()(key_type);
+ *     };
+ * };
+ * 
+ * \endcode
+ * 
+ * If an object of type KeyGen k maps [0, N) in a manner such that
+ * k(x) < k(x+1) for all x in [0, N-1), then this class can perform
+ * some optimizations in the lookup phase.  If key_type cannot be
+ * compared using <, or if the result of such a comparison is not
+ * convertible to bool, then this check will be skipped.
+ * 
+ * If the keys are not sorted but key_type can be hashed by static_hash
+ * (integral and enumeration types can be), a minimal perfect hash is
+ * built at compile time instead, which makes lookups O(1).  Otherwise,
+ * if the keys can be compared and are unique, they are sorted at
+ * compile time, which makes lookups O(lg(N)).  at_index() and
+ * key_at_index() always use generator order.
+ *
+ * If the keys are integers (or enumerations) of the form a*i + b, for
+ * example a contiguous range in either direction, the index of a key
+ * is computed arithmetically instead of searched for.  That makes a
+ * lookup about as fast as a static_table lookup.
+ *
+ * The map is built with loops rather than recursion, so N is not
+ * bounded by the template or constexpr depth.  It is bounded by the
+ * compiler's constexpr evaluation budget instead: past roughly 2^15
+ * hashed or 2^18 sorted entries, GCC needs larger
+ * -fconstexpr-loop-limit and -fconstexpr-ops-limit values and Clang a
+ * larger -fconstexpr-steps.  See static_table_build_bench.cpp for
+ * how compile time and compiler memory grow with N.
+ *
+ * If the keys are searched linearly and some are looked up far more
+ * often than others, static_search::profiled stores them hottest
+ * first.  profile_counter collects the hit counts it needs.
+ *
+ * If most lookups are expected to miss, a static_filter::bloom filter
+ * can be put in front of the search.  It rejects most missing keys in
+ * a few instructions; its estimated false positive rate and its size
+ * are filter_fpr and filter_bytes.
+ *
+ * A perfectly hashed map can store each key next to its value, or next
+ * to the part of its value that most lookups read, so that a hit
+ * touches one cache line instead of two (see static_storage).
+ *
+ * \tparam N The number of entries in the lookup table
+ * \tparam KeyGen A type that maps a sequence to a series of keys
+ * \tparam Fn A type that maps a key to a value
+ * \tparam Search A static_search tag that selects the lookup strategy
+ * \tparam Filter A static_filter tag that selects a filter for misses
+ * \tparam Instrument A static_instrument tag that selects what is
+ * recorded about lookups
+ * \tparam Reverse A static_reverse tag that selects an index from
+ * values to keys
+ * \tparam Storage A static_storage tag that selects how the keys and
+ * values are laid out
+ */
+template <unsigned N, class KeyGen, class Fn,
+	class Search = static_search::automatic,
+	class Filter = static_filter::none,
+	class Instrument = static_instrument::none,
+	class Reverse = static_reverse::none,
+	class Storage = static_storage::separate>
+class static_map {
+public:
+    //public typedefs
+    ///The type of the keys in the map
+    typedef decltype((KeyGen{})(0U)) key_type;
+    ///The type of the mapped values in the map
+    //can't assume that key_type is default constructible
+    typedef decltype((Fn{})((KeyGen{})(0U))) value_type;
+    ///Shorthand form for the type of this object
+    typedef static_map<N, KeyGen, Fn, Search, Filter, Instrument, Reverse,
+		Storage> this_type;
+    ///The static_instrument tag that records the lookups
+    typedef Instrument instrument_type;
+    ///The number of (key, value) pairs in the map
+    static constexpr unsigned length = N;
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+
+	//profile_counter searches map directly and counts by slot
+	template <class Map>
+	friend class profile_counter;
+
+	//don't document this section
+	#ifndef DOXYGEN
+	
+    //how to determine if the keys are sorted, and thus if the table
+    //can use binary search or must do a linear search
+    //
+    //For SFINAE the T must be key_type.
+    
+    //compare each pair of neighbours.  This is a loop rather than a
+    //recursion so that it is not limited by the constexpr depth.
+    template <class T = key_type>
+    static constexpr typename
+    std::enable_if<impl::comparable<T>::value, bool>::type
+    keys_sorted(KeyGen keygen) {
+		for (unsigned i = 1; i < N; ++i) {
+			//if the two are out of order, we aren't sorted
+			if (keygen(i) < keygen(i - 1)) {
+				return false;
+			}
+		}
+		return true;
+    }
+
+    //special case: we can't compare them (one element is still sorted)
+    template <class T = key_type>
+    static constexpr typename
+    std::enable_if<!impl::comparable<T>::value, bool>::type
+    keys_sorted(KeyGen) {
+        return N < 2;
+    }
+    
+    #endif
+    
+    /**
+     * Check if the keys are sorted.
+     * 
+     * \return True if the keys are sorted, false otherwise
+     */
+    //a pretty proxy that sets up the arguments correctly.
+    static constexpr bool keys_sorted() {
+		return keys_sorted(KeyGen());
+	}
+
+	/**
+	 * Check if a minimal perfect hash can be built for the keys.
+	 *
+	 * This is only attempted when the chosen strategy could use it.
+	 *
+	 * \return True if the keys can be perfectly hashed
+	 */
+	static constexpr bool keys_hashed() {
+		return impl::phf_ok<
+			impl::hashable<key_type>::value &&
+				(std::is_same<Search, static_search::perfect_hash>::value ||
+				(std::is_same<Search, static_search::automatic>::value &&
+					!keys_affine() && !keys_sorted())),
+			N, impl::hash_map<N, key_type, value_type>::buckets,
+			key_type, KeyGen
+		>();
+	}
+
+	/**
+	 * Check if the keys are integers in arithmetic progression.
+	 *
+	 * This is only attempted when the chosen strategy could use it.
+	 *
+	 * \return True if the keys can be indexed directly
+	 */
+	static constexpr bool keys_affine() {
+		return impl::affine_ok<
+			(std::is_integral<key_type>::value || std::is_enum<key_type>::value) &&
+				(std::is_same<Search, static_search::direct>::value ||
+				std::is_same<Search, static_search::automatic>::value),
+			N, key_type, KeyGen
+		>();
+	}
+
+	/**
+	 * Check if the keys can be sorted at compile time.
+	 *
+	 * This is only attempted when the chosen strategy could use it.
+	 *
+	 * \return True if the keys can be compared and are unique
+	 */
+	static constexpr bool keys_sortable() {
+		return impl::sort_ok<
+			impl::comparable<key_type>::value &&
+				(std::is_same<Search, static_search::sort>::value ||
+				(std::is_same<Search, static_search::automatic>::value &&
+					!keys_affine() && !keys_sorted() && !keys_hashed())),
+			N, KeyGen
+		>();
+	}
+
+	///the type that the search strategy picked
+	typedef typename impl::map_storage<
+		Search, keys_sorted(), keys_hashed(), keys_affine(), keys_sortable(),
+		N, key_type, value_type
+	>::type search_t;
+
+	///the type that stores and searches the (key, value) pairs
+	typedef typename impl::map_layout<Storage, search_t>::type map_t;
+
+    ///the instance of the map itself.
+    const map_t map;
+
+	///the type of the filter in front of map
+	typedef typename impl::map_filter<Filter, impl::hashable<key_type>::value,
+		N, key_type>::type filter_t;
+
+	///the filter in front of map
+	const filter_t filter;
+
+	///the type of the index from values to keys
+	typedef typename impl::map_reverse<Reverse, impl::comparable<value_type>::value,
+		impl::hashable<value_type>::value, N, value_type>::type reverse_t;
+
+	///the index from values to keys
+	const reverse_t reverse;
+
+	static_assert(std::is_same<Reverse, static_reverse::none>::value ||
+		std::is_same<Storage, static_storage::separate>::value,
+		"a static_reverse index requires static_storage::separate");
+
+	#ifndef DOXYGEN
+	//search unless the filter rejects k
+	constexpr unsigned search(key_type k) const {
+		return filter.may_contain(k) ? map.find(k) : N;
+	}
+
+	//pass the slot a lookup of k found to the instrumentation
+	constexpr unsigned seen(key_type k, unsigned s) const {
+		return Instrument::template record<this_type>(map, k, s);
+	}
+
+	//helpers for the non-throwing lookups, so the search runs once
+	constexpr const value_type* find_slot(unsigned s) const {
+		return (s != N) ? &impl::stored_value(map, s) : nullptr;
+	}
+
+	constexpr value_type get_or_slot(unsigned s, value_type fallback) const {
+		return (s != N) ? impl::stored_value(map, s) : fallback;
+	}
+
+	template <class M>
+	constexpr const typename M::H* hot_slot(unsigned s) const {
+		return (s != N) ? &map.entries[s].value : nullptr;
+	}
+
+	//helpers for the ordered queries.  Keys sorted at compile time are
+	//stored in sorted order; otherwise the ith key is the ith generated
+	constexpr const unsigned* rank_slots() const {
+		return permuted ? nullptr : impl::rank_slots(map);
+	}
+
+	//the first key whose value is in the range r of reverse
+	constexpr const key_type* reverse_first(std::pair<unsigned, unsigned> r) const {
+		return (r.first != r.second) ? &map.keys[reverse.slots[r.first]] : nullptr;
+	}
+
+	//the keys whose values are in the range r of reverse
+	constexpr static_view<key_type> keys_in(std::pair<unsigned, unsigned> r) const {
+		return static_view<key_type>(map.keys, reverse.slots + r.first,
+			r.second - r.first);
+	}
+
+	constexpr key_type sorted_key(unsigned i) const {
+		return impl::stored_key(map, permuted ? i : map.slot(i));
+	}
+
+	constexpr unsigned floor_of(unsigned upper) const {
+		return (upper != 0) ? upper - 1 : N;
+	}
+
+	//find the slots of up to 64 keys for lookup().  With a filter, only
+	//the keys that get past it are searched for
+	template <unsigned Width>
+	void find_batch(std::false_type, const key_type* keys, unsigned* slots, unsigned m) const {
+		impl::find_batch<Width>(map, keys, slots, m);
+	}
+
+	template <unsigned Width>
+	void find_batch(std::true_type, const key_type* keys, unsigned* slots, unsigned m) const {
+		key_type passed[64];
+		unsigned where[64];
+		unsigned found[64];
+		unsigned p = 0;
+		for (unsigned k = 0; k < m; ++k) {
+			slots[k] = N;
+			if (filter.may_contain(keys[k])) {
+				passed[p] = keys[k];
+				where[p++] = k;
+			}
+		}
+		impl::find_batch<Width>(map, passed, found, p);
+		for (unsigned k = 0; k < p; ++k) {
+			slots[where[k]] = found[k];
+		}
+	}
+	#endif
+
+	#ifndef DOXYGEN
+    //this does the heavy lifting of generating the table
+    constexpr static_map(KeyGen keygen, Fn func) :
+        //initialize table - generate all keys, and then all values   
+        map(map_t::build(keygen, func)),
+        filter(filter_t::build(keygen)),
+        reverse(reverse_t::build(map))
+    {
+        //
+    }
+    #endif
+public:
+
+    /**
+     * Construct a static_map
+     */
+    constexpr static_map() : 
+        static_map(KeyGen(), Fn())
+    {
+		//
+	}
+
+	/**
+	 * Look up a key in the map.
+	 * 
+	 * This function is constexpr, so it can be computed at compile
+	 * time if k is itself constexpr.
+	 * 
+	 * The time complexity of this operation is O(lg(N)) if the keys
+	 * are sorted (strictly increasing) or can be sorted, O(1) if the
+	 * keys are in arithmetic progression, are perfectly hashed or are
+	 * near-linear and use static_search::interpolation, and O(N) in all
+	 * other cases.
+	 *
+	 * The value is returned by reference into the map, so large values
+	 * are not copied, and the reference is valid as long as the map.
+	 * 
+	 * \param k A key
+	 * \return The value that k maps to.
+	 * 
+	 * \throws key_not_found_error key is not in this map
+	 */
+    constexpr const value_type& operator[](key_type k) const {
+        return impl::stored_value(map, impl::checked_index<N>(seen(k, search(k))));
+    }
+
+	/**
+	 * The largest error of the learned index.
+	 *
+	 * This is only available with static_search::interpolation.  It is
+	 * the furthest any key is stored from where the model predicts, so
+	 * a lookup binary searches at most 2*max_error() + 3 positions.  It
+	 * is constexpr, so it can be checked with static_assert.
+	 *
+	 * \return The largest prediction error, in positions
+	 */
+	constexpr unsigned max_error() const {
+		return map.model.max_error;
+	}
+
+	/**
+	 * Look up a key in the map without throwing.
+	 *
+	 * This performs the same search as operator[](), but reports a
+	 * miss by returning a null pointer, so it is cheap when many keys
+	 * are expected to be missing.  It is constexpr.
+	 *
+	 * \param k A key
+	 * \return A pointer to the value that k maps to, or nullptr if k is
+	 * not in this map.
+	 */
+	constexpr const value_type* find(key_type k) const {
+		return find_slot(seen(k, search(k)));
+	}
+
+	/**
+	 * Check if a key is in the map.
+	 *
+	 * \param k A key
+	 * \return True if k is in this map, false otherwise
+	 */
+	constexpr bool contains(key_type k) const {
+		return seen(k, search(k)) != N;
+	}
+
+	/**
+	 * Look up a key in the map, with a fallback value.
+	 *
+	 * \param k A key
+	 * \param fallback The value to return if k is not in this map
+	 * \return The value that k maps to, or fallback
+	 */
+	constexpr value_type get_or(key_type k, value_type fallback) const {
+		return get_or_slot(seen(k, search(k)), fallback);
+	}
+
+	/**
+	 * Look up the hot field of a key's value.
+	 *
+	 * This needs static_storage::hot_cold.  The field is stored next to
+	 * the key, so unlike operator[]() this reads one cache line.
+	 *
+	 * \param k A key
+	 * \return Hot()(v) for the value v that k maps to
+	 *
+	 * \throws key_not_found_error key is not in this map
+	 */
+	template <class M = map_t>
+	constexpr const typename M::H& hot(key_type k) const {
+		return map.entries[impl::checked_index<N>(seen(k, search(k)))].value;
+	}
+
+	/**
+	 * Look up the hot field of a key's value without throwing.
+	 *
+	 * \param k A key
+	 * \return A pointer to the hot field of the value that k maps to
+	 * (see hot()), or nullptr if k is not in this map
+	 */
+	template <class M = map_t>
+	constexpr const typename M::H* find_hot(key_type k) const {
+		return hot_slot<M>(seen(k, search(k)));
+	}
+
+	/**
+	 * Get the value at a certain index in the underlying table.
+	 * 
+	 * This is a lower-level function.  It should not be used often.
+	 * It might be useful in certain situation for optimization
+	 * purposes or in unusual use cases.
+	 * 
+	 * Conceptually, this is equivalent to doing a lookup on KeyGen and
+	 * then a lookup on Fn.  Its time complexity is O(1).
+	 * 
+	 * This function, being lower level, is not bounds checked.
+	 * 
+	 * \param i The index
+	 * \return The ith value stored/mapped to in this map.
+	 */
+    constexpr const value_type& at_index(unsigned i) const {
+        return impl::stored_value(map, map.slot(i));
+    }
+	
+	/**
+	 * Get the key at a certain index in the underlying table.
+	 * 
+	 * This is a lower-level function.  It should not be used often.
+	 * It might be useful in certain situation for optimization
+	 * purposes or in unusual use cases.
+	 * 
+	 * This can be viewed as a lookup table for KeyGen.  For reverse
+	 * lookups, see keys_of().  Its time complexity is O(1).
+	 * 
+	 * This function, being lower level, is not bounds checked.
+	 * 
+	 * \param i The index
+	 * \return The ith key stored/mapped in this map.
+	 */
+    constexpr const key_type& key_at_index(unsigned i) const {
+        return impl::stored_key(map, map.slot(i));
+    }
+	
+	/**
+	 * Find the first key that is not less than a key.
+	 *
+	 * This and the other ordered queries below need keys that are
+	 * sorted in generator order or sorted at compile time
+	 * (static_search::sort).  They run the map's own search, so they
+	 * take about as long as operator[]().  Positions are in sorted
+	 * order, as in keys() and values().
+	 *
+	 * \param k A key
+	 * \return The position of the first key that is not less than k, or
+	 * N if there is none
+	 */
+	constexpr unsigned lower_bound(key_type k) const {
+		static_assert(sorted || permuted, "ordered queries require sorted "
+			"keys or static_search::sort");
+		return impl::lower_rank(map, k);
+	}
+
+	/**
+	 * Find the first key that is greater than a key.
+	 *
+	 * If keys repeat, this steps over the copies of k one at a time.
+	 *
+	 * \param k A key
+	 * \return The position of the first key that is greater than k, or
+	 * N if there is none
+	 */
+	constexpr unsigned upper_bound(key_type k) const {
+		unsigned i = lower_bound(k);
+		while (i != N && !(k < sorted_key(i))) {
+			++i;
+		}
+		return i;
+	}
+
+	/**
+	 * Find the positions of the keys equal to a key.
+	 *
+	 * \param k A key
+	 * \return The pair (lower_bound(k), upper_bound(k))
+	 */
+	constexpr std::pair<unsigned, unsigned> equal_range(key_type k) const {
+		return std::pair<unsigned, unsigned>(lower_bound(k), upper_bound(k));
+	}
+
+	/**
+	 * Find the largest key that is not greater than a key.
+	 *
+	 * \param k A key
+	 * \return The position of that key, or N if every key is greater
+	 */
+	constexpr unsigned floor(key_type k) const {
+		return floor_of(upper_bound(k));
+	}
+
+	/**
+	 * Find the smallest key that is not less than a key.
+	 *
+	 * This is the same as lower_bound().
+	 *
+	 * \param k A key
+	 * \return The position of that key, or N if every key is less
+	 */
+	constexpr unsigned ceiling(key_type k) const {
+		return lower_bound(k);
+	}
+
+	/**
+	 * View the keys in sorted order.
+	 *
+	 * This needs sorted keys, as lower_bound() does, and
+	 * static_storage::separate, as the view reads an array of keys.
+	 *
+	 * \return A view of the N keys
+	 */
+	constexpr static_view<key_type> keys() const {
+		static_assert(sorted || permuted, "ordered queries require sorted "
+			"keys or static_search::sort");
+		static_assert(std::is_same<Storage, static_storage::separate>::value,
+			"keys() and values() require static_storage::separate");
+		return static_view<key_type>(map.keys, rank_slots(), N);
+	}
+
+	/**
+	 * View the values in the sorted order of their keys.
+	 *
+	 * This needs sorted keys and static_storage::separate, as keys()
+	 * does.
+	 *
+	 * \return A view of the N values
+	 */
+	constexpr static_view<value_type> values() const {
+		static_assert(sorted || permuted, "ordered queries require sorted "
+			"keys or static_search::sort");
+		static_assert(std::is_same<Storage, static_storage::separate>::value,
+			"keys() and values() require static_storage::separate");
+		return static_view<value_type>(map.values, rank_slots(), N);
+	}
+
+	/**
+	 * Find the keys that map to a value.
+	 *
+	 * This and the other reverse lookups below need a reverse index
+	 * (see static_reverse).  A value that no key maps to gives an empty
+	 * view; none of them throw.  They are constexpr.
+	 *
+	 * \param v A value
+	 * \return A view of the keys that map to v, in generator order
+	 */
+	constexpr static_view<key_type> keys_of(const value_type& v) const {
+		static_assert(reversed, "reverse lookups require a static_reverse index");
+		return keys_in(reverse.range(map.values, v));
+	}
+
+	/**
+	 * Find the first key that maps to a value.
+	 *
+	 * \param v A value
+	 * \return A pointer to the first generated key that maps to v, or
+	 * nullptr if no key does
+	 */
+	constexpr const key_type* find_key(const value_type& v) const {
+		static_assert(reversed, "reverse lookups require a static_reverse index");
+		return reverse_first(reverse.range(map.values, v));
+	}
+
+	/**
+	 * Check if some key maps to a value.
+	 *
+	 * \param v A value
+	 * \return True if a key in this map maps to v, false otherwise
+	 */
+	constexpr bool contains_value(const value_type& v) const {
+		return find_key(v) != nullptr;
+	}
+
+	/**
+	 * Find the first key that maps to a value, with a fallback key.
+	 *
+	 * \param v A value
+	 * \param fallback The key to return if no key maps to v
+	 * \return The first generated key that maps to v, or fallback
+	 */
+	constexpr key_type key_or(const value_type& v, key_type fallback) const {
+		const key_type* k = find_key(v);
+		return k ? *k : fallback;
+	}
+
+	/**
+	 * Look up several keys at once.
+	 *
+	 * values[j] receives the value that keys[j] maps to.  Small maps
+	 * that are searched linearly compare 4 or 8 stored keys at a time
+	 * with SSE2 or AVX2 if the CPU supports it (checked at runtime).
+	 * Sorted and hashed maps run Width searches in lockstep and
+	 * prefetch each search's next probe before making the current one,
+	 * which hides memory latency when the map does not fit in cache.
+	 * If the map has a filter, the keys it rejects are dropped before
+	 * the searches.  The results are always identical to calling
+	 * operator[]() on each key.
+	 *
+	 * If found is not null, found[j] is set to whether keys[j] is in the
+	 * map and values[j] is left untouched if it is not.  If found is
+	 * null, a missing key throws key_not_found_error, and the values
+	 * before it have already been written.
+	 *
+	 * \tparam Width How many searches to interleave
+	 * \param keys The keys to look up
+	 * \param values Receives the n values
+	 * \param n The number of keys
+	 * \param found Optionally receives whether each key was found
+	 *
+	 * \throws key_not_found_error a key is not in this map and found is
+	 * null
+	 */
+	template <unsigned Width = 8>
+	void lookup(const key_type* keys, value_type* values, unsigned n,
+		bool* found = nullptr) const
+	{
+		static_assert(Width > 0, "lookup() needs a Width of at least 1");
+		//find slots a block at a time to keep them in registers/L1
+		constexpr unsigned block = 64;
+		unsigned slots[block];
+		for (unsigned j = 0; j < n; j += block) {
+			const unsigned m = (n - j < block) ? n - j : block;
+			find_batch<Width>(std::integral_constant<bool, filtered>(),
+				keys + j, slots, m);
+			for (unsigned k = 0; instrumented && k < m; ++k) {
+				seen(keys[j + k], slots[k]);
+			}
+			for (unsigned k = 0; k < m; ++k) {
+				if (found) {
+					found[j + k] = (slots[k] != N);
+				}
+				if (slots[k] != N) {
+					values[j + k] = impl::stored_value(map, slots[k]);
+				}
+				else if (!found) {
+					impl::key_not_found();
+				}
+			}
+		}
+	}
+
+	///if the keys are sorted
+    static constexpr bool sorted = keys_sorted();
+    ///if lookups use a minimal perfect hash
+    static constexpr bool hashed =
+		std::is_same<search_t, impl::hash_map<N, key_type, value_type>>::value;
+    ///if the keys were sorted at compile time
+    static constexpr bool permuted =
+		std::is_same<map_t, impl::permuted_map<N, key_type, value_type>>::value;
+    ///if lookups compute the index directly
+    static constexpr bool direct =
+		std::is_same<map_t, impl::affine_map<N, key_type, value_type>>::value;
+    ///if a filter rejects missing keys before the search
+    static constexpr bool filtered =
+		!std::is_same<filter_t, impl::no_filter>::value;
+    ///the estimated fraction of missing keys that get past the filter
+    ///(1 without a filter)
+    static constexpr double filter_fpr = filter_t::fpr;
+    ///the size of the filter in bytes
+    static constexpr std::size_t filter_bytes = filter_t::bytes;
+    ///if lookups are recorded
+    static constexpr bool instrumented =
+		!std::is_same<Instrument, static_instrument::none>::value;
+    ///if there is an index from values to keys
+    static constexpr bool reversed =
+		!std::is_same<reverse_t, impl::no_reverse>::value;
+};
+
+/**
+ * Counts the lookups in a static_map, to profile it.
+ *
+ * This wraps a map and forwards lookups to it, counting the hits on
+ * each key and the misses.  write() prints the hit counts in generator
+ * order, one per line with a trailing comma, so that a run's profile
+ * can be baked into the next build as the weights of
+ * static_search::profiled:
+ *
+ * \code{.cpp}
+ *
+ * //in a profiling build
+ * profile_counter<decltype(verbs)> counter(verbs);
+ * //...look up keys through counter instead of verbs, then
+ * std::ofstream out("verb_hits.inc");
+ * counter.write(out);
+ *
+ * //in the next build
+ * constexpr unsigned long long verb_hits[] = {
+ * #include "verb_hits.inc"
+ * };
+ * struct verb_profile {
+ *     constexpr unsigned long long operator()(unsigned i) {
+ *         return verb_hits[i];
+ *     }
+ * };
+ * constexpr static_map<16, verb_keys, verb_values,
+ *     static_search::profiled<verb_profile>> verbs;
+ *
+ * \endcode
+ *
+ * Counting costs one increment per lookup.  A counter is not
+ * synchronized, so each thread should count into its own and merge()
+ * them at the end.
+ *
+ * \tparam Map The static_map type
+ */
+template <class Map>
+class profile_counter {
+public:
+	///The type of the keys in the map
+	typedef typename Map::key_type key_type;
+	///The type of the mapped values in the map
+	typedef typename Map::value_type value_type;
+	///The number of (key, value) pairs in the map
+	static constexpr unsigned length = Map::length;
+
+	/**
+	 * Start counting lookups in a map.
+	 *
+	 * \param m The map; it must outlive the counter
+	 */
+	explicit profile_counter(const Map& m) :
+		map(m), hits{}, missed(0)
+	{
+		//
+	}
+
+	/**
+	 * Look up a key in the map and count it.
+	 *
+	 * \param k A key
+	 * \return The value that k maps to.
+	 *
+	 * \throws key_not_found_error key is not in the map
+	 */
+	const value_type& operator[](key_type k) {
+		const unsigned s = count(k);
+		if (s == length) {
+			static_table_impl::key_not_found();
+		}
+		return *map.find_slot(s);
+	}
+
+	///look up a key and count it (see static_map::find())
+	const value_type* find(key_type k) {
+		const unsigned s = count(k);
+		return map.find_slot(s);
+	}
+
+	///look up a key and count it (see static_map::contains())
+	bool contains(key_type k) {
+		return count(k) != length;
+	}
+
+	///look up a key and count it (see static_map::get_or())
+	value_type get_or(key_type k, value_type fallback) {
+		const unsigned s = count(k);
+		return map.get_or_slot(s, fallback);
+	}
+
+	/**
+	 * The number of lookups of the ith generated key.
+	 *
+	 * \param i The generator index
+	 * \return How many times key_at_index(i) was found
+	 */
+	std::uint64_t hits_at_index(unsigned i) const {
+		return hits[map.map.slot(i)];
+	}
+
+	///the number of lookups of keys that are not in the map
+	std::uint64_t misses() const {
+		return missed;
+	}
+
+	/**
+	 * Add another counter's counts to this one.
+	 *
+	 * \param other A counter of the same map, for example from
+	 * another thread
+	 */
+	void merge(const profile_counter& other) {
+		for (unsigned s = 0; s < length; ++s) {
+			hits[s] += other.hits[s];
+		}
+		missed += other.missed;
+	}
+
+	///set every count to zero
+	void reset() {
+		for (unsigned s = 0; s < length; ++s) {
+			hits[s] = 0;
+		}
+		missed = 0;
+	}
+
+	/**
+	 * Write the hit counts in generator order.
+	 *
+	 * Each count is followed by a comma and a newline, so the output
+	 * can be included in an array initializer.
+	 *
+	 * \param out A stream (anything with operator<< for integers and
+	 * strings)
+	 */
+	template <class Stream>
+	void write(Stream& out) const {
+		for (unsigned i = 0; i < length; ++i) {
+			out << hits_at_index(i) << ",\n";
+		}
+	}
+private:
+	///search the map and count the result
+	unsigned count(key_type k) {
+		const unsigned s = map.search(k);
+		++((s != length) ? hits[s] : missed);
+		return s;
+	}
+
+	///the map being profiled
+	const Map& map;
+	///hits[s] is the number of lookups that found slot s
+	std::uint64_t hits[length];
+	///the number of lookups that missed
+	std::uint64_t missed;
+};
+
+/**
+ * A statically initialized lookup table.
+ * 
+ * The Fn type is a function type that maps an unsigned index to a
+ * value.
+ * 
+ * This class can be thought of as an optimized version of static_map
+ * where KeyGen is the identity function.
+ * 
+ * Calling an object of type Fn MUST be a constexpr operation, and Fn
+ * MUST be a constexpr default constructable function object.
+ * 
+ * To use regular functions, see the global function generate_static_table().
+ * 
+ * To illustrate:
+ * 
+ * \code{.cpp}
+ * 
+ * //this may be used with either constructor
+ * template <typename value_type>
+ * struct Fn {
+ *     constexpr value_type operator()(unsigned);
+ * };
+ * 
+ * \endcode
+ * 
+ * If the values are trivially default constructible the table is
+ * filled in a loop, so N is only bounded by the compiler's constexpr
+ * loop and operation limits (see static_map).
+ *
+ * \tparam N The number of entries in the lookup table
+ * \tparam Fn A type that maps a key to a value
+ * \tparam Instrument A static_instrument tag that selects what is
+ * recorded about lookups
+ * 
+ */
+template <unsigned N, class Fn,
+	class Instrument = static_instrument::none>
+class static_table {
+public:
+    //public typedefs
+	///The type of the keys in the table (for compatibility with static_map)
+    typedef unsigned key_type;
+    ///The type of the values in the table
+    typedef decltype((Fn{})(0U)) value_type;
+	///Shorthand form for the type of this object
+    typedef static_table<N, Fn, Instrument> this_type;
+    ///The static_instrument tag that records the lookups
+    typedef Instrument instrument_type;
+    ///The number of values in the table
+    static constexpr unsigned length = N;
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+	
+    ///the actual lookup table (not const, so that it can be filled in
+    ///a loop; every accessor is const)
+    value_type table[N];
+
+	#ifndef DOXYGEN
+	//pass a lookup of i to the instrumentation, as found if i < N
+	constexpr unsigned seen(unsigned i) const {
+		return Instrument::template record<this_type>(*this, i, (i < N) ? i : N);
+	}
+	#endif
+
+	#ifndef DOXYGEN
+    //this does the heavy lifting of generating the table, in a loop if
+    //value_type allows it (see static_table_impl::loop_buildable)
+    constexpr static_table(std::true_type, Fn func) :
+        table{}
+    {
+        for (unsigned i = 0; i < N; ++i) {
+            table[i] = func(i);
+        }
+    }
+
+    constexpr static_table(std::false_type, Fn func) :
+        static_table(impl::gen_seq<N>(), func)
+    {
+        //
+    }
+
+    template <unsigned... Is>
+    constexpr static_table(impl::seq<Is...>, Fn func) :
+        //initialize table - generate values    
+        table{ func(Is)... }
+    {
+        //
+    }
+    
+    //make this private to maintain consistency & compatibility with
+    //static_map.  It's more intuitive if there's just *one* set of
+    //rules to follow.
+    
+    explicit constexpr static_table(Fn func) :
+		static_table(impl::loop_buildable<key_type, value_type>(), func)
+	{
+		//
+	}
+    #endif
+public:
+
+    /**
+     * Construct a static_table
+     */
+    constexpr static_table() : 
+        static_table(Fn()) 
+    {
+		//
+	}
+
+	/**
+	 * Look up an index in the table.
+	 * 
+	 * This function is constexpr, so it can be computed at compile
+	 * time if i is itself constexpr.
+	 * 
+	 * The time complexity of this operation is O(1).
+	 * 
+	 * This function is not bounds checked.  The value is returned by
+	 * reference into the table, so large values are not copied.
+	 * 
+	 * \param i An index
+	 * \return The value at i.
+	 */
+    constexpr const value_type& operator[](unsigned i) const {
+        return table[instrumented ? (seen(i), i) : i];
+    }
+
+	/**
+	 * Look up an index in the table, with bounds checking.
+	 *
+	 * This is provided for compatibility with static_map::find().
+	 *
+	 * \param i An index
+	 * \return A pointer to the value at i, or nullptr if i >= N
+	 */
+	constexpr const value_type* find(unsigned i) const {
+		return (seen(i) < N) ? &table[i] : nullptr;
+	}
+
+	/**
+	 * Check if an index is in the table.
+	 *
+	 * \param i An index
+	 * \return True if i < N
+	 */
+	constexpr bool contains(unsigned i) const {
+		return seen(i) < N;
+	}
+
+	/**
+	 * Look up an index in the table, with a fallback value.
+	 *
+	 * \param i An index
+	 * \param fallback The value to return if i >= N
+	 * \return The value at i, or fallback
+	 */
+	constexpr value_type get_or(unsigned i, value_type fallback) const {
+		return (seen(i) < N) ? table[i] : fallback;
+	}
+    	
+    /**
+	 * Look up an index in the table.
+	 * 
+	 * This function is exactly the same as operator[]().  It is provided
+	 * for convenience and compatibility with static_map.
+	 * 
+	 * This function is constexpr, so it can be computed at compile
+	 * time if i is itself constexpr.
+	 * 
+	 * The time complexity of this operation is O(1).
+	 * 
+	 * This function is not bounds checked.
+	 * 
+	 * \param i An index
+	 * \return The value at i.
+	 */
+    constexpr const value_type& at_index(unsigned i) const {
+		return table[i];
+	}
+	
+	/**
+	 * Find the index of a key
+	 * 
+	 * This function is simply the identity function.  It is provided
+	 * for interface compatibility with static_map.
+	 * 
+	 * \param i The index
+	 * \return i
+	 */
+	constexpr unsigned key_at_index(unsigned i) const {
+		return i;
+	}
+
+	/**
+	 * Look up several indices at once.
+	 *
+	 * values[j] receives the value at indices[j].  4 and 8 byte values
+	 * are loaded with AVX2 gathers if the CPU supports it (checked at
+	 * runtime).  The results are always identical to calling
+	 * operator[]() on each index.
+	 *
+	 * Like operator[](), this is not bounds checked.  found is provided
+	 * for compatibility with static_map, and is always set to true.
+	 *
+	 * \param indices The indices to look up
+	 * \param values Receives the n values
+	 * \param n The number of indices
+	 * \param found Optionally receives whether each index was found
+	 */
+	void lookup(const unsigned* indices, value_type* values, unsigned n,
+		bool* found = nullptr) const
+	{
+		impl::gather(table, indices, values, n);
+		for (unsigned j = 0; instrumented && j < n; ++j) {
+			seen(indices[j]);
+		}
+		for (unsigned j = 0; found && j < n; ++j) {
+			found[j] = true;
+		}
+	}
+
+	///if the keys are sorted - provided for compatibility with static_map
+    static constexpr bool sorted = true; //always true (0...N always sorted)
+    ///if lookups are recorded
+    static constexpr bool instrumented =
+		!std::is_same<Instrument, static_instrument::none>::value;
+};
+
+/**
+ * A statically initialized lookup table with bit-packed values.
+ *
+ * This is a drop-in replacement for static_table when the values are
+ * integers (or enumerations) that span a small range.  Each value is
+ * stored as its difference from the smallest value (frame of
+ * reference), in the fewest bits that hold every difference.  A table
+ * of 32 bit values that all fit in 12 bits takes 12 bits per entry
+ * instead of 32.
+ *
+ * Lookups decode one field, so they are O(1), but they take a few more
+ * instructions than a static_table lookup.  This pays off when the
+ * table would otherwise not fit in cache.
+ *
+ * There are no references to the stored values, so there is no find().
+ *
+ * \tparam N The number of entries in the lookup table
+ * \tparam Fn A type that maps a key to an integral or enumeration value
+ */
+template <unsigned N, class Fn>
+class packed_static_table {
+public:
+    //public typedefs
+	///The type of the keys in the table (for compatibility with static_map)
+    typedef unsigned key_type;
+    ///The type of the values in the table
+    typedef decltype((Fn{})(0U)) value_type;
+	///Shorthand form for the type of this object
+    typedef packed_static_table<N, Fn> this_type;
+    ///The number of values in the table
+    static constexpr unsigned length = N;
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+
+	static_assert(std::is_integral<value_type>::value ||
+		std::is_enum<value_type>::value,
+		"packed_static_table requires integral or enumeration values");
+
+	///the integer type that values are converted through
+	typedef typename impl::packed_int<value_type>::type int_type;
+
+	///the frame of reference
+	static constexpr impl::packed_range range = impl::pack_range<N, value_type>(Fn());
+
+public:
+	///The number of bits stored per value
+	static constexpr unsigned bits = range.bits;
+	///The smallest value in the table, which every value is stored
+	///relative to
+	static constexpr value_type reference =
+		static_cast<value_type>(static_cast<int_type>(range.min));
+
+private:
+	///the low bits bits set
+	static constexpr std::uint64_t mask =
+		(bits < 64) ? (std::uint64_t{1} << bits) - 1 : ~std::uint64_t{0};
+	///how many words the packed values need, plus one so that
+	///impl::unpack() can always read the next word
+	static constexpr std::uint64_t num_words =
+		(std::uint64_t{N} * bits + 63) / 64 + 1;
+
+	///the packed values
+	std::uint64_t words[num_words];
+
+	///convert a decoded difference back to a value
+	static constexpr value_type decode(std::uint64_t d) {
+		return static_cast<value_type>(static_cast<int_type>(range.min + d));
+	}
+
+	#ifndef DOXYGEN
+    //this does the heavy lifting of generating the table
+    explicit constexpr packed_static_table(Fn func) :
+        words{}
+    {
+        for (unsigned i = 0; i < N; ++i) {
+            const std::uint64_t d = static_cast<std::uint64_t>(
+                static_cast<int_type>(func(i))) - range.min;
+            const std::uint64_t off = std::uint64_t{i} * bits;
+            const unsigned sh = off & 63;
+            words[off >> 6] |= d << sh;
+            //the field straddles two words
+            if (sh + bits > 64) {
+                words[(off >> 6) + 1] |= d >> (64 - sh);
+            }
+        }
+    }
+    #endif
+public:
+
+    /**
+     * Construct a packed_static_table
+     */
+    constexpr packed_static_table() :
+        packed_static_table(Fn())
+    {
+		//
+	}
+
+	/**
+	 * Look up an index in the table.
+	 *
+	 * This function is constexpr, so it can be computed at compile
+	 * time if i is itself constexpr.
+	 *
+	 * The time complexity of this operation is O(1).
+	 *
+	 * This function is not bounds checked.
+	 *
+	 * \param i An index
+	 * \return The value at i.
+	 */
+    constexpr value_type operator[](unsigned i) const {
+        return decode(impl::unpack(words, std::uint64_t{i} * bits, mask));
+    }
+
+	/**
+	 * Check if an index is in the table.
+	 *
+	 * \param i An index
+	 * \return True if i < N
+	 */
+	constexpr bool contains(unsigned i) const {
+		return i < N;
+	}
+
+	/**
+	 * Look up an index in the table, with a fallback value.
+	 *
+	 * \param i An index
+	 * \param fallback The value to return if i >= N
+	 * \return The value at i, or fallback
+	 */
+	constexpr value_type get_or(unsigned i, value_type fallback) const {
+		return (i < N) ? (*this)[i] : fallback;
+	}
+
+	///the same as operator[]() (see static_table::at_index())
+    constexpr value_type at_index(unsigned i) const {
+		return (*this)[i];
+	}
+
+	///the identity (see static_table::key_at_index())
+	constexpr unsigned key_at_index(unsigned i) const {
+		return i;
+	}
+
+	/**
+	 * Decode a range of the table.
+	 *
+	 * values[j] receives the value at first + j.  If the CPU supports
+	 * AVX2 (checked at runtime) and values take at most 56 bits, 4
+	 * values are decoded per step.
+	 *
+	 * This is not bounds checked.
+	 *
+	 * \param first The first index to decode
+	 * \param n The number of values
+	 * \param values Receives the n values
+	 */
+	void decode(unsigned first, unsigned n, value_type* values) const {
+		unsigned j = 0;
+		#ifdef STATIC_TABLE_X86_SIMD
+		if (bits <= 56 && impl::simd() == impl::simd_avx2) {
+			//decode a block at a time to keep the buffer in L1
+			constexpr unsigned block = 64;
+			std::uint64_t buf[block];
+			while (n - j >= 4) {
+				const unsigned m = (n - j < block) ? n - j : block;
+				const unsigned done = impl::unpack_avx2(words,
+					std::uint64_t{first + j} * bits, bits, range.min, buf, m);
+				for (unsigned k = 0; k < done; ++k) {
+					values[j + k] = static_cast<value_type>(
+						static_cast<int_type>(buf[k]));
+				}
+				j += done;
+			}
+		}
+		#endif
+		for (; j < n; ++j) {
+			values[j] = (*this)[first + j];
+		}
+	}
+
+	/**
+	 * Look up several indices at once.
+	 *
+	 * This is provided for compatibility with static_table::lookup().
+	 * It is not bounds checked, and found is always set to true.
+	 *
+	 * \param indices The indices to look up
+	 * \param values Receives the n values
+	 * \param n The number of indices
+	 * \param found Optionally receives whether each index was found
+	 */
+	void lookup(const unsigned* indices, value_type* values, unsigned n,
+		bool* found = nullptr) const
+	{
+		for (unsigned j = 0; j < n; ++j) {
+			values[j] = (*this)[indices[j]];
+		}
+		for (unsigned j = 0; found && j < n; ++j) {
+			found[j] = true;
+		}
+	}
+
+	///if the keys are sorted - provided for compatibility with static_map
+    static constexpr bool sorted = true; //always true (0...N always sorted)
+};
+
+/**
+ * A statically initialized lookup map for sparse integer keys.
+ *
+ * This is an alternative to static_map when the keys are integers (or
+ * enumerations) spread thinly over a range, such as 50k keys between 0
+ * and 2^24.  Instead of storing the keys, the map stores one bit per
+ * integer in [smallest key, largest key], set for the keys that are in
+ * the map, and a rank directory that counts the bits set before every
+ * 64 bit word.  Together they take 1.25 bits per integer in the range
+ * (see universe).  The values are stored in the order of their keys.
+ *
+ * A lookup tests the key's bit, and the number of bits set before it
+ * (one popcount plus two directory reads) is the index of the value,
+ * so lookups are O(1) and branch free apart from the miss check.  That
+ * is faster than searching N stored keys, and far smaller than a
+ * static_table over the whole range.  The bitmap is also smaller than
+ * the keys themselves once more than about 1 in 25 integers of the
+ * range is a 32 bit key.
+ *
+ * Positions are in sorted key order: at_index(i) is the value of the
+ * ith smallest key, and key_at_index(i) finds that key by binary
+ * searching the directory, which is O(lg(universe)).
+ *
+ * The keys must be unique; a duplicate is a compile-time error.  The
+ * values must be trivially default constructible, because they are
+ * placed in a loop.  The map is built in loops, so N and the range are
+ * bounded like static_map's (see static_map).
+ *
+ * \tparam N The number of entries in the map
+ * \tparam KeyGen A type that maps [0, N) to integral or enumeration keys
+ * \tparam Fn A type that maps a key to a value
+ */
+template <unsigned N, class KeyGen, class Fn>
+class sparse_static_map {
+public:
+    //public typedefs
+    ///The type of the keys in the map
+    typedef decltype((KeyGen{})(0U)) key_type;
+    ///The type of the mapped values in the map
+    typedef decltype((Fn{})((KeyGen{})(0U))) value_type;
+	///Shorthand form for the type of this object
+    typedef sparse_static_map<N, KeyGen, Fn> this_type;
+    ///The number of (key, value) pairs in the map
+    static constexpr unsigned length = N;
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+
+	static_assert(N > 0, "sparse_static_map needs at least one key");
+	static_assert(std::is_integral<key_type>::value ||
+		std::is_enum<key_type>::value,
+		"sparse_static_map requires integral or enumeration keys");
+	static_assert(std::is_trivially_default_constructible<value_type>::value,
+		"sparse_static_map requires trivially default constructible values");
+
+	///the integer type that keys are converted through
+	typedef typename impl::packed_int<key_type>::type int_type;
+
+	///the smallest key and the size of the key range
+	static constexpr impl::sparse_range range =
+		impl::sparse_build<N, key_type>(KeyGen());
+
+	static_assert(range.span / 512 < 0xFFFFFFFFULL,
+		"sparse_static_map key range is too large");
+
+public:
+	///The number of integers from the smallest key to the largest
+	static constexpr std::uint64_t universe = range.span + 1;
+	///The smallest key in the map
+	static constexpr key_type reference =
+		static_cast<key_type>(static_cast<int_type>(range.min));
+
+private:
+	///the number of 512 bit blocks in the bitmap
+	static constexpr unsigned num_blocks =
+		static_cast<unsigned>(range.span / 512 + 1);
+
+	///the bitmap and its rank directory
+	impl::rank_block blocks[num_blocks];
+	///the values, in the order of their keys
+	value_type values[N];
+
+	///the slot of a key, which is >= universe if the key is out of range
+	static constexpr std::uint64_t slot_of(key_type k) {
+		return static_cast<std::uint64_t>(static_cast<int_type>(k)) - range.min;
+	}
+
+	///check if the bit of an in-range slot is set
+	constexpr bool has(std::uint64_t d) const {
+		return (blocks[d >> 9].words[(d >> 6) & 7] >> (d & 63)) & 1;
+	}
+
+	///the index of the value of k, or N if k is not in this map
+	constexpr unsigned find_index(key_type k) const {
+		return (slot_of(k) < universe && has(slot_of(k))) ?
+			impl::rank(blocks, slot_of(k)) : N;
+	}
+
+	#ifndef DOXYGEN
+    //this does the heavy lifting of generating the map: set the bits,
+    //count them, then place each value at its key's rank
+    constexpr sparse_static_map(KeyGen keygen, Fn func) :
+        blocks{}, values{}
+    {
+        for (unsigned i = 0; i < N; ++i) {
+            const std::uint64_t d = slot_of(keygen(i));
+            blocks[d >> 9].words[(d >> 6) & 7] |= std::uint64_t{1} << (d & 63);
+        }
+        unsigned total = 0;
+        for (unsigned b = 0; b < num_blocks; ++b) {
+            blocks[b].base = total;
+            unsigned before = 0;
+            for (unsigned k = 1; k < 8; ++k) {
+                before += impl::popcount64(blocks[b].words[k - 1]);
+                blocks[b].counts |= std::uint64_t{before} << (9 * k - 9);
+            }
+            total += before + impl::popcount64(blocks[b].words[7]);
+        }
+        //fewer bits than keys means two keys share a bit
+        if (total != N) {
+            impl::bad_keys("sparse_static_map keys must be unique");
+        }
+        for (unsigned i = 0; i < N; ++i) {
+            const key_type k = keygen(i);
+            values[impl::rank(blocks, slot_of(k))] = func(k);
+        }
+    }
+    #endif
+public:
+
+    /**
+     * Construct a sparse_static_map
+     */
+    constexpr sparse_static_map() :
+        sparse_static_map(KeyGen(), Fn())
+    {
+		//
+	}
+
+	/**
+	 * Look up a key in the map.
+	 *
+	 * This function is constexpr, so it can be computed at compile
+	 * time if k is itself constexpr.
+	 *
+	 * The time complexity of this operation is O(1).
+	 *
+	 * \param k A key
+	 * \return The value that k maps to.
+	 *
+	 * \throws key_not_found_error key is not in this map
+	 */
+    constexpr const value_type& operator[](key_type k) const {
+        return values[impl::checked_index<N>(find_index(k))];
+    }
+
+	/**
+	 * Look up a key in the map without throwing.
+	 *
+	 * \param k A key
+	 * \return A pointer to the value that k maps to, or nullptr if k is
+	 * not in this map.
+	 */
+	constexpr const value_type* find(key_type k) const {
+		return (find_index(k) != N) ? &values[find_index(k)] : nullptr;
+	}
+
+	/**
+	 * Check if a key is in the map.
+	 *
+	 * This only tests the key's bit, so it does not count.
+	 *
+	 * \param k A key
+	 * \return True if k is in this map, false otherwise
+	 */
+	constexpr bool contains(key_type k) const {
+		return slot_of(k) < universe && has(slot_of(k));
+	}
+
+	/**
+	 * Look up a key in the map, with a fallback value.
+	 *
+	 * \param k A key
+	 * \param fallback The value to return if k is not in this map
+	 * \return The value that k maps to, or fallback
+	 */
+	constexpr value_type get_or(key_type k, value_type fallback) const {
+		return (find_index(k) != N) ? values[find_index(k)] : fallback;
+	}
+
+	/**
+	 * Count the keys that are less than a key.
+	 *
+	 * This is the same as static_map::lower_bound(); k does not need to
+	 * be in the map.  It is O(1).
+	 *
+	 * \param k A key
+	 * \return The position of the first key that is not less than k, or
+	 * N if there is none
+	 */
+	constexpr unsigned lower_bound(key_type k) const {
+		return (static_cast<int_type>(k) < static_cast<int_type>(reference)) ? 0 :
+			(slot_of(k) < universe) ? impl::rank(blocks, slot_of(k)) : N;
+	}
+
+	/**
+	 * Get the value of the ith smallest key.
+	 *
+	 * This function is not bounds checked.
+	 *
+	 * \param i The position, in sorted key order
+	 * \return The ith value
+	 */
+    constexpr const value_type& at_index(unsigned i) const {
+        return values[i];
+    }
+
+	/**
+	 * Get the ith smallest key.
+	 *
+	 * The key is not stored, so it is found in the bitmap, which is
+	 * O(lg(universe)).  This function is not bounds checked.
+	 *
+	 * \param i The position, in sorted key order
+	 * \return The ith key
+	 */
+    constexpr key_type key_at_index(unsigned i) const {
+        return static_cast<key_type>(static_cast<int_type>(
+            range.min + impl::select(blocks, num_blocks, i)));
     }
 
-    //special case: we have at least two, and we can't compare them
-    template <class T, unsigned I1, unsigned I2, unsigned... Is>
-    static constexpr typename
-    std::enable_if<!impl::comparable<T>::value, bool>::type
-    keys_sorted(KeyGen) {
-        return false;
-    }
+	/**
+	 * Look up several keys at once.
+	 *
+	 * This behaves like static_map::lookup(): found[j] is set to
+	 * whether keys[j] is in the map, and if found is null a missing key
+	 * throws key_not_found_error.
+	 *
+	 * \param keys The keys to look up
+	 * \param values Receives the n values
+	 * \param n The number of keys
+	 * \param found Optionally receives whether each key was found
+	 *
+	 * \throws key_not_found_error a key is not in this map and found is
+	 * null
+	 */
+	void lookup(const key_type* keys, value_type* values, unsigned n,
+		bool* found = nullptr) const
+	{
+		for (unsigned j = 0; j < n; ++j) {
+			const unsigned s = find_index(keys[j]);
+			if (found) {
+				found[j] = (s != N);
+			}
+			if (s != N) {
+				values[j] = this->values[s];
+			}
+			else if (!found) {
+				impl::key_not_found();
+			}
+		}
+	}
+
+	///the keys are always stored in sorted order
+    static constexpr bool sorted = true;
+};
+
+/**
+ * A statically initialized table that approximates a real function.
+ *
+ * This replaces a static_table of precomputed values plus a hand
+ * written lerp.  Fn is sampled at N evenly spaced points from
+ * Domain::lo to Domain::hi at compile time, and operator()() evaluates
+ * between the samples as selected by Mode (see static_interpolation).
+ * Arguments outside [lo, hi] are clamped.
+ *
+ * Fn is never called outside [lo, hi]: the spline's neighbours of the
+ * first and last samples are extrapolated linearly.  The largest error
+ * of the approximation, measured against Fn at 7 points inside every
+ * interval while the table is built, is available at compile time as
+ * max_error().
+ *
+ * \code{.cpp}
+ *
+ * struct unit { static constexpr double lo = 0, hi = 1; };
+ * struct curve {
+ *     constexpr double operator()(double x) { return x / (1 + x*x); }
+ * };
+ * constexpr interpolated_table<256, curve, unit> table;
+ * static_assert(table.max_error() < 1e-5, "table too coarse");
+ *
+ * \endcode
+ *
+ * The samples are built in a loop, so N is bounded like static_table's.
+ *
+ * \tparam N The number of samples, at least 2
+ * \tparam Fn A type that maps a real argument to a floating point value
+ * \tparam Domain A type with static constexpr members lo < hi
+ * \tparam Mode A static_interpolation tag
+ */
+template <unsigned N, class Fn, class Domain,
+	class Mode = static_interpolation::linear>
+class interpolated_table {
+public:
+	///The type of the arguments
+	typedef double key_type;
+	///The type of the values
+	typedef decltype((Fn{})(0.0)) value_type;
+	///Shorthand form for the type of this object
+	typedef interpolated_table<N, Fn, Domain, Mode> this_type;
+	///The number of samples
+	static constexpr unsigned length = N;
+	///The start of the domain
+	static constexpr double lo = Domain::lo;
+	///The end of the domain
+	static constexpr double hi = Domain::hi;
+
+	static_assert(N >= 2, "interpolated_table needs at least 2 samples");
+	static_assert(std::is_floating_point<value_type>::value,
+		"interpolated_table values must be floating point");
+	static_assert(Domain::lo < Domain::hi, "interpolated_table needs lo < hi");
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+
+	///samples per unit of the argument
+	static constexpr double scale = (N - 1) / (hi - lo);
+
+	///the samples, with an extrapolated one before and after
+	value_type samples[N + 2];
+	///the largest error found while building
+	value_type error;
+
+	#ifndef DOXYGEN
+	static constexpr double sample_point(unsigned i) {
+		return (i == N - 1) ? hi : lo + (hi - lo) * i / (N - 1);
+	}
+
+	static constexpr value_type magnitude(value_type v) {
+		return (v < 0) ? -v : v;
+	}
+
+	//the argument as a position in samples, clamped to [0, N - 1]
+	static constexpr double position(double x) {
+		const double u = (x - lo) * scale;
+		const double low = (u > 0) ? u : 0;
+		return (low < N - 1) ? low : N - 1;
+	}
+
+	constexpr value_type at(double u, static_interpolation::nearest) const {
+		return samples[static_cast<unsigned>(u + 0.5) + 1];
+	}
+
+	constexpr value_type at(double u, static_interpolation::linear) const {
+		const unsigned i = (static_cast<unsigned>(u) < N - 2) ?
+			static_cast<unsigned>(u) : N - 2;
+		const value_type t = static_cast<value_type>(u - i);
+		return samples[i + 1] + t * (samples[i + 2] - samples[i + 1]);
+	}
+
+	constexpr value_type at(double u, static_interpolation::cubic) const {
+		const unsigned i = (static_cast<unsigned>(u) < N - 2) ?
+			static_cast<unsigned>(u) : N - 2;
+		return impl::catmull_rom(samples[i], samples[i + 1], samples[i + 2],
+			samples[i + 3], static_cast<value_type>(u - i));
+	}
+
+	explicit constexpr interpolated_table(Fn func) :
+		samples{}, error{}
+	{
+		for (unsigned i = 0; i < N; ++i) {
+			samples[i + 1] = func(sample_point(i));
+		}
+		samples[0] = samples[1] + samples[1] - samples[2];
+		samples[N + 1] = samples[N] + samples[N] - samples[N - 1];
+		for (unsigned i = 0; i + 1 < N; ++i) {
+			for (unsigned k = 1; k < 8; ++k) {
+				const double x = lo + (i + k / 8.0) / scale;
+				const value_type e = magnitude(func(x) - (*this)(x));
+				error = (e > error) ? e : error;
+			}
+		}
+	}
+	#endif
+public:
+
+	/**
+	 * Construct an interpolated_table
+	 */
+	constexpr interpolated_table() :
+		interpolated_table(Fn())
+	{
+		//
+	}
+
+	/**
+	 * Approximate Fn at a point.
+	 *
+	 * This is O(1) and constexpr.
+	 *
+	 * \param x The argument, clamped to [lo, hi]
+	 * \return The approximation of Fn at x
+	 */
+	constexpr value_type operator()(double x) const {
+		return at(position(x), Mode());
+	}
+
+	/**
+	 * The largest error of the approximation.
+	 *
+	 * This is the largest difference from Fn found at 7 evenly spaced
+	 * points inside each interval between samples.  It is constexpr, so
+	 * it can be checked with static_assert.
+	 *
+	 * \return The largest error found
+	 */
+	constexpr value_type max_error() const {
+		return error;
+	}
+
+	/**
+	 * Approximate Fn at several points.
+	 *
+	 * ys[j] receives (*this)(xs[j]).  Tables of doubles evaluate 4
+	 * points at a time with AVX2 if the CPU supports it (checked at
+	 * runtime), with the same operations in the same order, so the
+	 * results are identical to calling operator()() unless the compiler
+	 * is allowed to contract them into fused multiply-adds (for
+	 * example, -march=native with GCC's default -ffp-contract=fast).
+	 *
+	 * \param xs The arguments
+	 * \param ys Receives the n approximations
+	 * \param n The number of arguments
+	 */
+	void evaluate(const double* xs, value_type* ys, unsigned n) const {
+		unsigned j = 0;
+		#ifdef STATIC_TABLE_X86_SIMD
+		if (std::is_same<value_type, double>::value && impl::simd() == impl::simd_avx2) {
+			j = impl::interpolate_avx2<Mode::order>(
+				reinterpret_cast<const double*>(samples), N - 1, lo, scale,
+				xs, reinterpret_cast<double*>(ys), n);
+		}
+		#endif
+		for (; j < n; ++j) {
+			ys[j] = (*this)(xs[j]);
+		}
+	}
+
+	/**
+	 * Get a sample.
+	 *
+	 * \param i The index of the sample, in [0, N)
+	 * \return Fn at key_at_index(i)
+	 */
+	constexpr value_type at_index(unsigned i) const {
+		return samples[i + 1];
+	}
 
-    //special case: one element is always sorted
-    template <class T, unsigned I>
-    static constexpr bool keys_sorted(KeyGen) {
-        return true;
-    }
-    
-    //transforms the sequence into variadic argument list to pass to
-    //the other templates
-    template <unsigned... Is>
-    static constexpr bool keys_sorted(impl::seq<Is...>) {
-        return keys_sorted<key_type, Is...>(KeyGen());
-    }
-    
-    #endif
-    
-    /**
-     * Check if the keys are sorted.
-     * 
-     * \return True if the keys are sorted, false otherwise
-     */
-    //a pretty proxy that sets up the arguments correctly.
-    static constexpr bool keys_sorted() {
-		return keys_sorted(impl::gen_seq<N>());
+	/**
+	 * Get the point a sample was taken at.
+	 *
+	 * \param i The index of the sample, in [0, N)
+	 * \return The argument that sample i was computed from
+	 */
+	constexpr double key_at_index(unsigned i) const {
+		return sample_point(i);
 	}
+};
 
-    ///the instance of the map itself.
-    const map_t<keys_sorted()> map;
+/**
+ * A statically initialized multi-dimensional lookup table.
+ *
+ * This replaces nested static_tables.  Fn maps one index per dimension
+ * to a value, and the cells are stored in the order selected by Layout
+ * (see static_layout):
+ *
+ * - row_major is the layout of nested arrays.  Neighbours along the
+ *   last dimension are adjacent, but neighbours along the first are a
+ *   whole slice apart.
+ * - tiled<T> keeps T^D blocks of cells together, so a stencil touches
+ *   about the same number of cache lines in every direction.
+ * - morton interleaves the bits of the indices, which does the same at
+ *   every scale at once.
+ *
+ * Tiled and Morton layouts pad each dimension (to whole tiles or to a
+ * power of two), so they can store more cells than there are indices.
+ * The layout is computed at compile time as one small table per
+ * dimension, so a lookup costs one load and one add per dimension
+ * whatever the layout.
+ *
+ * \code{.cpp}
+ *
+ * struct height {
+ *     constexpr float operator()(unsigned x, unsigned y) { return x * y; }
+ * };
+ * constexpr static_grid<height, static_layout::morton, 64, 64> grid;
+ * static_assert(grid(3, 5) == 15, "");
+ *
+ * \endcode
+ *
+ * The values must be trivially default constructible, since the grid
+ * is filled in a loop.
+ *
+ * \tparam Fn A type that maps sizeof...(Dims) unsigned indices to a value
+ * \tparam Layout A static_layout tag
+ * \tparam Dims The extent of each dimension
+ */
+template <class Fn, class Layout, unsigned... Dims>
+class static_grid {
+public:
+	///The number of dimensions
+	static constexpr unsigned dimensions = sizeof...(Dims);
+	///The type of the values in the grid
+	typedef decltype((Fn{})(static_cast<unsigned>(Dims * 0)...)) value_type;
+	///Shorthand form for the type of this object
+	typedef static_grid<Fn, Layout, Dims...> this_type;
+private:
+
+	//decrease verbosity
+	typedef static_table_impl impl;
+
+public:
+	///The number of cells that have an index
+	static constexpr unsigned length = impl::grid_product(Dims...);
+	///The number of cells stored, including padding
+	static constexpr unsigned storage =
+		impl::grid_product(impl::grid_padded(Dims, Layout())...);
+
+	static_assert(dimensions > 0 && length > 0,
+		"static_grid needs at least one dimension and no empty ones");
+	static_assert(impl::loop_buildable<unsigned, value_type>::value,
+		"static_grid values must be trivially default constructible");
+
+	/**
+	 * The extent of a dimension.
+	 *
+	 * \param k The dimension, in [0, dimensions)
+	 * \return The number of indices along dimension k
+	 */
+	static constexpr unsigned extent(unsigned k) {
+		const unsigned d[] = { Dims... };
+		return d[k];
+	}
+private:
+
+	///the cells, in Layout order
+	value_type cells[storage];
+	///the offset each index of each dimension contributes to a cell's
+	unsigned spread[impl::grid_sum(Dims...)];
+	///the extent of each dimension
+	unsigned sizes[dimensions];
+	///where each dimension starts in spread
+	unsigned starts[dimensions];
 
 	#ifndef DOXYGEN
-    //this does the heavy lifting of generating the table
-    template <unsigned... Is>
-    constexpr static_map(impl::seq<Is...>, KeyGen keygen, Fn func) :
-        //initialize table - generate all keys, and then all values   
-        map{ { keygen(Is)... } , { func(keygen(Is))... } }
-    {
-        //
-    }
-    #endif
+	//read the box of cells for neighbourhood(), one dimension per level
+	template <unsigned K, unsigned Side>
+	typename std::enable_if<(K + 1 < sizeof...(Dims)), value_type*>::type
+	fetch_box(const unsigned (*offs)[Side], unsigned base, value_type* out) const {
+		for (unsigned r = 0; r < Side; ++r) {
+			out = fetch_box<K + 1, Side>(offs, base + offs[K][r], out);
+		}
+		return out;
+	}
+
+	template <unsigned K, unsigned Side>
+	typename std::enable_if<(K + 1 == sizeof...(Dims)), value_type*>::type
+	fetch_box(const unsigned (*offs)[Side], unsigned base, value_type* out) const {
+		for (unsigned r = 0; r < Side; ++r) {
+			out[r] = cells[base + offs[K][r]];
+		}
+		return out + Side;
+	}
+
+	template <unsigned... Is>
+	static constexpr value_type invoke(Fn& func, const unsigned* index, impl::seq<Is...>) {
+		return func(index[Is]...);
+	}
+
+	explicit constexpr static_grid(Fn func) :
+		cells{}, spread{}, sizes{ Dims... }, starts{}
+	{
+		for (unsigned k = 1; k < dimensions; ++k) {
+			starts[k] = starts[k - 1] + sizes[k - 1];
+		}
+		impl::grid_spread(sizes, dimensions, starts, spread, Layout());
+		//visit every index in row-major order, updating the offset as
+		//the indices change (mod 2^32, so it may wrap in between)
+		unsigned index[dimensions] = {};
+		unsigned off = 0;
+		for (unsigned k = 0; k < dimensions; ++k) {
+			off += spread[starts[k]];
+		}
+		for (unsigned n = 0; n < length; ++n) {
+			cells[off] = invoke(func, index,
+				typename impl::template gen_seq<dimensions>::type());
+			for (unsigned k = dimensions; k-- > 0;) {
+				off -= spread[starts[k] + index[k]];
+				if (++index[k] < sizes[k]) {
+					off += spread[starts[k] + index[k]];
+					break;
+				}
+				index[k] = 0;
+				off += spread[starts[k]];
+			}
+		}
+	}
+	#endif
 public:
 
-    /**
-     * Construct a static_map
-     */
-    constexpr static_map() : 
-        static_map(impl::gen_seq<N>(), KeyGen(), Fn())
-    {
+	/**
+	 * Construct a static_grid
+	 */
+	constexpr static_grid() :
+		static_grid(Fn())
+	{
 		//
 	}
 
 	/**
-	 * Look up a key in the map.
-	 * 
-	 * This function is constexpr, so it can be computed at compile
-	 * time if k is itself constexpr.
-	 * 
-	 * The time complexity of this operation is O(lg(N)) if the keys
-	 * are sorted (strictly increasing), and O(N) in all other cases.
-	 * 
-	 * \param k A key
-	 * \return The value that k maps to.
-	 * 
-	 * \throws key_not_found_error key is not in this map
+	 * The storage offset of a cell.
+	 *
+	 * This is not bounds checked.
+	 *
+	 * \param index One index per dimension
+	 * \return The position of the cell in the layout, in [0, storage)
 	 */
-    constexpr value_type operator[](key_type k) {
-        return map[k];
-    }
+	constexpr unsigned offset(const unsigned* index) const {
+		unsigned off = 0;
+		for (unsigned k = 0; k < dimensions; ++k) {
+			off += spread[starts[k] + index[k]];
+		}
+		return off;
+	}
 
 	/**
-	 * Get the value at a certain index in the underlying table.
-	 * 
-	 * This is a lower-level function.  It should not be used often.
-	 * It might be useful in certain situation for optimization
-	 * purposes or in unusual use cases.
-	 * 
-	 * Conceptually, this is equivalent to doing a lookup on KeyGen and
-	 * then a lookup on Fn.  Its time complexity is O(1).
-	 * 
-	 * This function, being lower level, is not bounds checked.
-	 * 
-	 * \param i The index
-	 * \return The ith value stored/mapped to in this map.
+	 * The storage offset of a cell.
+	 *
+	 * \param i One index per dimension
+	 * \return The position of the cell in the layout
 	 */
-    constexpr value_type at_index(unsigned i) {
-        return map.values[i];
-    }
-	
+	template <class... Is>
+	constexpr unsigned offset_of(Is... i) const {
+		const unsigned index[] = { static_cast<unsigned>(i)... };
+		return offset(index);
+	}
+
 	/**
-	 * Get the key at a certain index in the underlying table.
-	 * 
-	 * This is a lower-level function.  It should not be used often.
-	 * It might be useful in certain situation for optimization
-	 * purposes or in unusual use cases.
-	 * 
-	 * This function in particular might be useful for reverse
-	 * lookups.  Additionally, this can be viewed as a lookup table for
-	 * KeyGen.  Its time complexity is O(1).
-	 * 
-	 * This function, being lower level, is not bounds checked.
-	 * 
-	 * \param i The index
-	 * \return The ith key stored/mapped in this map.
+	 * Look up a cell.
+	 *
+	 * This is O(dimensions) and constexpr.  It is not bounds checked.
+	 *
+	 * \param i One index per dimension
+	 * \return Fn(i...)
 	 */
-    constexpr key_type key_at_index(unsigned i) {
-        return map.keys[i];
-    }
-	
-	///if the keys are sorted
-    static constexpr bool sorted = decltype(map)::sorted;
+	template <class... Is>
+	constexpr value_type operator()(Is... i) const {
+		static_assert(sizeof...(Is) == dimensions,
+			"static_grid needs one index per dimension");
+		const unsigned index[] = { static_cast<unsigned>(i)... };
+		return cells[offset(index)];
+	}
+
+	/**
+	 * Look up a cell by an array of indices.
+	 *
+	 * \param index One index per dimension
+	 * \return The value of the cell
+	 */
+	constexpr value_type at(const unsigned (&index)[sizeof...(Dims)]) const {
+		return cells[offset(index)];
+	}
+
+	/**
+	 * Check if a cell exists.
+	 *
+	 * \param index One index per dimension
+	 * \return True if every index is less than its extent
+	 */
+	constexpr bool contains(const unsigned (&index)[sizeof...(Dims)]) const {
+		for (unsigned k = 0; k < dimensions; ++k) {
+			if (index[k] >= sizes[k]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Look up several cells at once.
+	 *
+	 * values[j] receives the cell at indices[j*dimensions] ...
+	 * indices[j*dimensions + dimensions - 1].  This is not bounds
+	 * checked.
+	 *
+	 * \param indices dimensions indices per cell
+	 * \param values Receives the n values
+	 * \param n The number of cells
+	 */
+	void lookup(const unsigned* indices, value_type* values, unsigned n) const {
+		for (unsigned j = 0; j < n; ++j) {
+			values[j] = cells[offset(indices + j * dimensions)];
+		}
+	}
+
+	/**
+	 * Fetch the cells around a cell, for stencils.
+	 *
+	 * out receives the (2R + 1)^dimensions cells whose indices differ
+	 * from centre by at most R in every dimension, in row-major order
+	 * of the offsets from -R to R.  Indices past the edges are clamped,
+	 * so edge cells repeat.  The layout offsets of each dimension are
+	 * computed once, then the cells are read in a nested loop.
+	 *
+	 * \tparam R The radius of the neighbourhood
+	 * \param centre One index per dimension
+	 * \param out Receives the cells
+	 */
+	template <unsigned R = 1>
+	void neighbourhood(const unsigned (&centre)[sizeof...(Dims)], value_type* out) const {
+		constexpr unsigned side = 2 * R + 1;
+		unsigned offs[dimensions][side];
+		for (unsigned k = 0; k < dimensions; ++k) {
+			for (unsigned r = 0; r < side; ++r) {
+				const long long c = static_cast<long long>(centre[k]) + r - R;
+				const long long low = (c > 0) ? c : 0;
+				const unsigned i = (low < sizes[k]) ? static_cast<unsigned>(low) : sizes[k] - 1;
+				offs[k][r] = spread[starts[k] + i];
+			}
+		}
+		fetch_box<0, side>(offs, 0, out);
+	}
 };
 
 /**
- * A statically initialized lookup table.
- * 
- * The Fn type is a function type that maps an unsigned index to a
- * value.
- * 
- * This class can be thought of as an optimized version of static_map
- * where KeyGen is the identity function.
- * 
- * Calling an object of type Fn MUST be a constexpr operation, and Fn
- * MUST be a constexpr default constructable function object.
- * 
- * To use regular functions, see the global function generate_static_table().
- * 
- * To illustrate:
- * 
+ * A table of handlers, one per index, built at compile time.
+ *
+ * Handler<I>::run is the handler of index I, for example of the
+ * message type with ID I.  The table holds a pointer to each of them,
+ * taken when the program is compiled, so a constexpr dispatch_table is
+ * a constant array of function pointers with no static initializer.
+ * It is in .rodata, or in .data.rel.ro (read-only after relocation)
+ * in a position independent executable.
+ *
  * \code{.cpp}
- * 
- * //this may be used with either constructor
- * template <typename value_type>
- * struct Fn {
- *     constexpr value_type operator()(unsigned);
+ *
+ * template <unsigned I>
+ * struct on_message {
+ *     static void run(const message& m);
  * };
- * 
+ * template <>
+ * struct on_message<0> {
+ *     static void run(const message& m) { ... }
+ * };
+ * ...
+ * constexpr dispatch_table<8, on_message> route;
+ * route.call(m.type, m);
+ *
  * \endcode
- * 
- * \tparam N The number of entries in the lookup table
- * \tparam Fn A type that maps a key to a value
- * 
+ *
+ * call() either calls through the table, or switches over the index
+ * and calls Handler<I>::run directly in each case (see
+ * static_dispatch).  A switch lets the compiler inline the handlers and
+ * predicts better than an indirect call on some CPUs, but it is only
+ * written out for a few handlers.  Both are constexpr if the handlers
+ * are.
+ *
+ * Every Handler<I>::run must have the same type, which must be a
+ * function that can be called through a pointer (a static member
+ * function, not a template).
+ *
+ * \tparam N The number of handlers
+ * \tparam Handler A class template whose instantiations for 0 to N - 1
+ * each have a static member function run
+ * \tparam Mode A static_dispatch tag that selects how call() dispatches
  */
-template <unsigned N, class Fn>
-class static_table {
+template <unsigned N, template <unsigned> class Handler,
+	class Mode = static_dispatch::automatic>
+class dispatch_table {
 public:
-    //public typedefs
-	///The type of the keys in the table (for compatibility with static_map)
-    typedef unsigned key_type;
-    ///The type of the values in the table
-    typedef decltype((Fn{})(0U)) value_type;
+	///The type of the indices (for compatibility with static_table)
+	typedef unsigned key_type;
+	///The type of a pointer to a handler
+	typedef decltype(&Handler<0>::run) value_type;
 	///Shorthand form for the type of this object
-    typedef static_table<N, Fn> this_type;
-    ///The number of values in the table
-    static constexpr unsigned length = N;
+	typedef dispatch_table<N, Handler, Mode> this_type;
+	///The number of handlers
+	static constexpr unsigned length = N;
+	///The most handlers that a switch is written out for
+	static constexpr unsigned switch_limit = 16;
+	///if call() switches over the index rather than using the table
+	static constexpr bool switched =
+		std::is_same<Mode, static_dispatch::switched>::value ||
+		(std::is_same<Mode, static_dispatch::automatic>::value && N <= switch_limit);
+
+	static_assert(N > 0, "a dispatch_table needs at least one handler");
+	static_assert(!switched || N <= switch_limit,
+		"static_dispatch::switched supports at most switch_limit handlers");
 private:
 
 	//decrease verbosity
 	typedef static_table_impl impl;
-	
-    ///the actual lookup table
-    const value_type table[N];
+
+	///the handlers, in index order
+	value_type table[N];
 
 	#ifndef DOXYGEN
-    //this does the heavy lifting of generating the table
-    template <unsigned... Is>
-    constexpr static_table(impl::seq<Is...>, Fn func) :
-        //initialize table - generate values    
-        table{ func(Is)... }
-    {
-        //
-    }
-    
-    //make this private to maintain consistency & compatibility with
-    //static_map.  It's more intuitive if there's just *one* set of
-    //rules to follow.
-    
-    explicit constexpr static_table(Fn func) :
-		static_table(impl::gen_seq<N>(), func)
+	template <unsigned... Is>
+	constexpr dispatch_table(impl::seq<Is...>) :
+		table{ &Handler<Is>::run... }
 	{
 		//
 	}
-    #endif
+
+	template <class... Args>
+	using result_of = decltype(std::declval<value_type>()(std::declval<Args>()...));
+
+	template <class... Args>
+	constexpr result_of<Args...> dispatch(std::false_type, unsigned i, Args&&... args) const {
+		return table[i](std::forward<Args>(args)...);
+	}
+
+	//the last handler is the default, so the compiler can drop the
+	//range check; the cases past it are the same
+	template <class... Args>
+	static constexpr result_of<Args...> dispatch(std::true_type, unsigned i, Args&&... args) {
+		switch (i) {
+		case 0: return run<0>(std::forward<Args>(args)...);
+		case 1: return run<1>(std::forward<Args>(args)...);
+		case 2: return run<2>(std::forward<Args>(args)...);
+		case 3: return run<3>(std::forward<Args>(args)...);
+		case 4: return run<4>(std::forward<Args>(args)...);
+		case 5: return run<5>(std::forward<Args>(args)...);
+		case 6: return run<6>(std::forward<Args>(args)...);
+		case 7: return run<7>(std::forward<Args>(args)...);
+		case 8: return run<8>(std::forward<Args>(args)...);
+		case 9: return run<9>(std::forward<Args>(args)...);
+		case 10: return run<10>(std::forward<Args>(args)...);
+		case 11: return run<11>(std::forward<Args>(args)...);
+		case 12: return run<12>(std::forward<Args>(args)...);
+		case 13: return run<13>(std::forward<Args>(args)...);
+		case 14: return run<14>(std::forward<Args>(args)...);
+		default: return run<N - 1>(std::forward<Args>(args)...);
+		}
+	}
+
+	template <unsigned I, class... Args>
+	static constexpr result_of<Args...> run(Args&&... args) {
+		return Handler<(I < N) ? I : N - 1>::run(std::forward<Args>(args)...);
+	}
+	#endif
 public:
 
-    /**
-     * Construct a static_table
-     */
-    constexpr static_table() : 
-        static_table(impl::gen_seq<N>(), Fn()) 
-    {
+	/**
+	 * Construct a dispatch_table
+	 */
+	constexpr dispatch_table() :
+		dispatch_table(impl::gen_seq<N>())
+	{
 		//
 	}
 
 	/**
-	 * Look up an index in the table.
-	 * 
-	 * This function is constexpr, so it can be computed at compile
-	 * time if i is itself constexpr.
-	 * 
-	 * The time complexity of this operation is O(1).
-	 * 
-	 * This function is not bounds checked.
-	 * 
-	 * \param i An index
-	 * \return The value at i.
-	 */
-    constexpr value_type operator[](unsigned i) {
-        return table[i];
-    }
-    	
-    /**
-	 * Look up an index in the table.
-	 * 
-	 * This function is exactly the same as operator[]().  It is provided
-	 * for convenience and compatibility with static_map.
-	 * 
-	 * This function is constexpr, so it can be computed at compile
-	 * time if i is itself constexpr.
-	 * 
-	 * The time complexity of this operation is O(1).
-	 * 
-	 * This function is not bounds checked.
-	 * 
+	 * Get the handler of an index.
+	 *
+	 * This is not bounds checked.
+	 *
 	 * \param i An index
-	 * \return The value at i.
+	 * \return &Handler<i>::run
 	 */
-    constexpr value_type at_index(unsigned i) {
+	constexpr value_type operator[](unsigned i) const {
 		return table[i];
 	}
-	
+
 	/**
-	 * Find the index of a key
-	 * 
-	 * This function is simply the identity function.  It is provided
-	 * for interface compatibility with static_map.
-	 * 
-	 * \param i The index
-	 * \return i
+	 * Call the handler of an index.
+	 *
+	 * This is not bounds checked: in the table form an index past the
+	 * end is undefined behaviour, and in the switched form it calls the
+	 * last handler.
+	 *
+	 * \param i An index
+	 * \param args The arguments to pass to the handler
+	 * \return What Handler<i>::run(args...) returns
 	 */
-	constexpr unsigned key_at_index(unsigned i) {
-		return i;
+	template <class... Args>
+	constexpr result_of<Args...> call(unsigned i, Args&&... args) const {
+		return dispatch(std::integral_constant<bool, switched>(), i,
+			std::forward<Args>(args)...);
 	}
-
-	///if the keys are sorted - provided for compatibility with static_map
-    static constexpr bool sorted = true; //always true (0...N always sorted)
 };
 
 #endif
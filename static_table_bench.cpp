@@ -0,0 +1,738 @@
+#include "lookup_stats.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 201703L
+#include <variant>
+#endif
+
+//build with optimizations, e.g. g++ -std=c++14 -O2 -pthread static_table_bench.cpp
+//(std::variant is only timed with -std=c++17)
+//set the table size with -DBENCH_N=...; past about 2^15 entries the
+//compiler's constexpr limits must be raised (see static_map).
+//
+//at the default size every map fits in L2, so the batch lookups have no
+//cache misses to hide and are no faster than single ones.  To time
+//them on maps that do not fit, add a hashed and an Eytzinger map of
+//BENCH_LARGE_N entries, e.g.
+//  -DBENCH_LARGE_N=262144 -fconstexpr-loop-limit=100000000
+//  -fconstexpr-ops-limit=4000000000
+//which takes GCC about 5 minutes more.  Keys and values take 8 bytes
+//per entry, so the maps need more than the last level cache / 8
+//entries to be timed from DRAM.
+//
+//the stencil grids are BENCH_GRID cells per side.  At the default of
+//48, a float grid takes 442 KB (Morton pads it to 64 per side, 1 MB),
+//so the layouts are timed from cache and run about the same.  Grids
+//that do not fit in L2 take much longer to build: 128 per side (8 MB)
+//takes GCC over 10 minutes with the limits above, and on a 2 MB L2
+//showed no layout consistently ahead from run to run.  A grid larger
+//than a server's last level cache is out of reach at compile time.
+
+#ifndef BENCH_N
+#define BENCH_N 16384
+#endif
+
+#ifndef BENCH_GRID
+#define BENCH_GRID 48
+#endif
+
+constexpr unsigned num = BENCH_N;
+constexpr unsigned probes = 1U << 20;
+
+struct sorted_keys {
+    constexpr unsigned operator()(unsigned i) {
+        return 2*i + 1;
+    }
+};
+
+struct scattered_keys {
+    constexpr unsigned operator()(unsigned i) {
+        return i * 2654435761U;
+    }
+};
+
+struct valuemap {
+    constexpr unsigned operator()(unsigned key) {
+        return key ^ (key >> 7);
+    }
+};
+
+constexpr static_map<num, sorted_keys, valuemap, static_search::binary> map_binary;
+constexpr static_map<num, sorted_keys, valuemap, static_search::eytzinger> map_eytzinger;
+constexpr static_map<num, sorted_keys, valuemap, static_search::interpolation> map_learned;
+constexpr static_map<num, sorted_keys, valuemap, static_search::direct> map_direct;
+constexpr static_map<num, scattered_keys, valuemap, static_search::perfect_hash> map_hashed;
+constexpr static_map<num, scattered_keys, valuemap, static_search::perfect_hash,
+    static_filter::bloom<100>> map_hashed_filtered;
+constexpr static_map<num, sorted_keys, valuemap, static_search::eytzinger,
+    static_filter::bloom<100>> map_eytzinger_filtered;
+
+#ifdef BENCH_LARGE_N
+constexpr static_map<BENCH_LARGE_N, sorted_keys, valuemap,
+    static_search::eytzinger> map_large_eytzinger;
+constexpr static_map<BENCH_LARGE_N, scattered_keys, valuemap,
+    static_search::perfect_hash> map_large_hashed;
+#endif
+
+struct eytzinger_name {
+    static const char* name() {
+        return "eytzinger";
+    }
+};
+
+struct hashed_name {
+    static const char* name() {
+        return "hashed";
+    }
+};
+
+//the same maps, counting their lookups
+constexpr static_map<num, sorted_keys, valuemap, static_search::eytzinger,
+    static_filter::none, static_instrument::counted<eytzinger_name>> map_eytzinger_counted;
+constexpr static_map<num, scattered_keys, valuemap, static_search::perfect_hash,
+    static_filter::none, static_instrument::counted<hashed_name>> map_hashed_counted;
+
+//hashed keys with an index from values back to keys.  Hashing the keys
+//and sorting the values both count against the constexpr budget, so
+//these are smaller
+constexpr unsigned reverse_num = (num > 4096) ? 4096 : num;
+constexpr static_map<reverse_num, scattered_keys, valuemap, static_search::perfect_hash,
+    static_filter::none, static_instrument::none, static_reverse::sorted> map_reverse_sorted;
+constexpr static_map<reverse_num, scattered_keys, valuemap, static_search::perfect_hash,
+    static_filter::none, static_instrument::none, static_reverse::hashed> map_reverse_hashed;
+
+//about 1 key per 64 integers, in increasing order
+struct sparse_keys {
+    constexpr unsigned operator()(unsigned i) {
+        return 64*i + ((i * 2654435761U) >> 26);
+    }
+};
+
+constexpr static_map<num, sparse_keys, valuemap> map_sparse_searched;
+constexpr sparse_static_map<num, sparse_keys, valuemap> map_sparse;
+
+//a small map whose last keys get almost every lookup
+constexpr unsigned verbs = 24;
+
+struct verb_keys {
+    constexpr unsigned operator()(unsigned i) {
+        return i * 2654435761U;
+    }
+};
+
+struct verb_profile {
+    constexpr unsigned operator()(unsigned i) {
+        return i;
+    }
+};
+
+constexpr static_map<verbs, verb_keys, valuemap, static_search::linear> map_verbs;
+constexpr static_map<verbs, verb_keys, valuemap,
+    static_search::profiled<verb_profile>> map_verbs_profiled;
+
+//HTTP header names, looked up from const char* probes
+constexpr unsigned headers = 32;
+constexpr const char* header_names[headers] = { "Accept", "Accept-Charset",
+    "Accept-Encoding", "Accept-Language", "Accept-Ranges", "Age", "Allow",
+    "Authorization", "Cache-Control", "Connection", "Content-Encoding",
+    "Content-Language", "Content-Length", "Content-Location", "Content-Range",
+    "Content-Type", "Cookie", "Date", "ETag", "Expect", "Expires", "From", "Host",
+    "If-Match", "If-Modified-Since", "If-None-Match", "If-Range",
+    "If-Unmodified-Since", "Last-Modified", "Location", "Referer", "User-Agent" };
+
+struct header_keys {
+    constexpr static_string operator()(unsigned i) {
+        return header_names[i];
+    }
+};
+
+struct header_length {
+    constexpr unsigned operator()(static_string name) {
+        return static_cast<unsigned>(name.size());
+    }
+};
+
+constexpr static_map<headers, header_keys, header_length> map_headers;
+constexpr static_map<headers, header_keys, header_length, static_search::binary> map_headers_sorted;
+constexpr static_map<headers, header_keys, header_length, static_search::linear> map_headers_linear;
+
+//a large value, such as a descriptor, of Words 4 byte words
+template <unsigned Words>
+struct descriptor {
+    unsigned words[Words];
+};
+
+template <unsigned Words>
+struct descriptor_of {
+    constexpr descriptor<Words> operator()(unsigned key) {
+        descriptor<Words> d{};
+        for (unsigned j = 0; j < Words; ++j) {
+            d.words[j] = key ^ j;
+        }
+        return d;
+    }
+};
+
+constexpr unsigned descriptors = 1024;
+constexpr static_table<descriptors, descriptor_of<16>> table_descriptors;
+constexpr static_map<descriptors, scattered_keys, descriptor_of<16>> map_descriptors;
+constexpr static_table<descriptors, descriptor_of<64>> table_descriptors_large;
+constexpr static_map<descriptors, scattered_keys, descriptor_of<64>> map_descriptors_large;
+
+//the hashed maps with their keys stored next to what a hit reads
+constexpr static_map<num, scattered_keys, valuemap, static_search::perfect_hash,
+    static_filter::none, static_instrument::none, static_reverse::none,
+    static_storage::interleaved> map_hashed_interleaved;
+
+struct first_word {
+    constexpr unsigned operator()(const descriptor<16>& d) {
+        return d.words[0];
+    }
+};
+
+template <class Storage>
+using descriptor_map = static_map<num, scattered_keys, descriptor_of<16>,
+    static_search::perfect_hash, static_filter::none, static_instrument::none,
+    static_reverse::none, Storage>;
+
+constexpr descriptor_map<static_storage::separate> map_layout_separate;
+constexpr descriptor_map<static_storage::interleaved> map_layout_interleaved;
+constexpr descriptor_map<static_storage::hot_cold<first_word>> map_layout_hot_cold;
+
+//the handler of message type I
+template <unsigned I>
+struct on_message {
+    static unsigned run(unsigned payload) {
+        return payload * (2*I + 1) + I;
+    }
+};
+
+constexpr dispatch_table<8, on_message> route_switched;
+constexpr dispatch_table<8, on_message, static_dispatch::table> route_small;
+constexpr dispatch_table<64, on_message> route_large;
+
+//the same handlers as virtual functions, one object per message type
+struct handler_base {
+    virtual unsigned run(unsigned payload) const = 0;
+};
+
+template <unsigned I>
+struct virtual_handler : handler_base {
+    unsigned run(unsigned payload) const override {
+        return on_message<I>::run(payload);
+    }
+};
+
+template <unsigned... Is>
+struct virtual_handlers {
+    std::tuple<virtual_handler<Is>...> objects;
+    const handler_base* table[sizeof...(Is)] = { &std::get<Is>(objects)... };
+};
+
+template <unsigned... Is>
+virtual_handlers<Is...> make_virtual(std::integer_sequence<unsigned, Is...>);
+
+decltype(make_virtual(std::make_integer_sequence<unsigned, 8>())) virtual_small;
+decltype(make_virtual(std::make_integer_sequence<unsigned, 64>())) virtual_large;
+
+struct curve_domain {
+    static constexpr double lo = 0;
+    static constexpr double hi = 8;
+};
+
+struct rational {
+    constexpr double operator()(double x) {
+        return x / (1 + x*x);
+    }
+};
+
+constexpr interpolated_table<1024, rational, curve_domain,
+    static_interpolation::nearest> table_nearest;
+constexpr interpolated_table<1024, rational, curve_domain> table_linear;
+constexpr interpolated_table<1024, rational, curve_domain,
+    static_interpolation::cubic> table_cubic;
+
+struct density {
+    constexpr float operator()(unsigned x, unsigned y, unsigned z) {
+        return static_cast<float>((x * 7 + y * 13 + z * 29) % 101);
+    }
+};
+
+constexpr unsigned side = BENCH_GRID;
+constexpr static_grid<density, static_layout::row_major, side, side, side> grid_rows;
+constexpr static_grid<density, static_layout::tiled<4>, side, side, side> grid_tiles;
+constexpr static_grid<density, static_layout::morton, side, side, side> grid_morton;
+
+unsigned keys[probes];
+unsigned values[probes];
+bool found[probes];
+
+//fill keys with random hits on m
+template <class Map>
+void make_keys(const Map& m) {
+    unsigned x = 12345;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        keys[i] = m.key_at_index((x >> 8) % m.length);
+    }
+}
+
+//time f() and return nanoseconds per probe
+template <class F>
+double time_probes(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / probes;
+}
+
+template <class Map, unsigned Width>
+double batched(const Map& m) {
+    return time_probes([&] { m.template lookup<Width>(keys, values, probes); });
+}
+
+//print the throughput of single key lookups and each batch width
+template <class Map>
+void curve(const char* name, const Map& m) {
+    make_keys(m);
+    unsigned sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += m[keys[i]];
+        }
+    });
+    std::cout << name << "\tsingle\t" << single << " ns\n";
+    std::cout << name << "\t1\t" << batched<Map, 1>(m) << " ns\n";
+    std::cout << name << "\t2\t" << batched<Map, 2>(m) << " ns\n";
+    std::cout << name << "\t4\t" << batched<Map, 4>(m) << " ns\n";
+    std::cout << name << "\t8\t" << batched<Map, 8>(m) << " ns\n";
+    std::cout << name << "\t16\t" << batched<Map, 16>(m) << " ns\n";
+    std::cout << name << "\t32\t" << batched<Map, 32>(m) << " ns\n";
+    //keep the single key loop from being optimized out
+    std::cout << name << "\tchecksum\t" << (sum ^ values[probes - 1]) << '\n';
+}
+
+//print the time of a single key lookup and the size of the map
+template <class Map>
+void sparse(const char* name, const Map& m) {
+    make_keys(m);
+    unsigned sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += m[keys[i]];
+        }
+    });
+    std::cout << name << "\t" << single << " ns\t" << sizeof(m) << " bytes\t" << sum << '\n';
+}
+
+//print the time of a lookup when 1 in 16 keys is in the map
+template <class Map>
+void misses(const char* name, const Map& m) {
+    make_keys(m);
+    unsigned x = 54321;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        keys[i] = (i % 16) ? x | 0x80000000U : keys[i];
+    }
+    unsigned sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += m.get_or(keys[i], 1);
+        }
+    });
+    double batch = time_probes([&] { m.lookup(keys, values, probes, found); });
+    std::cout << name << "\t" << single << " ns\t" << batch << " ns\t"
+        << m.filter_bytes << " bytes\t" << sum << '\n';
+}
+
+//print the time of single and batched lookups that all hit
+template <class Map>
+void instrumented(const char* name, const Map& m) {
+    make_keys(m);
+    unsigned sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += m[keys[i]];
+        }
+    });
+    double batch = time_probes([&] { m.lookup(keys, values, probes); });
+    std::cout << name << "\t" << single << " ns\t" << batch << " ns\t"
+        << sizeof(m) << " bytes\t" << (sum ^ values[probes - 1]) << '\n';
+}
+
+//print the time of finding the key of a value, with m's reverse index
+//and by scanning the values (timed on a sample, as it takes O(N))
+template <class Map>
+void reverse(const char* name, const Map& m) {
+    unsigned x = 12345;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        keys[i] = m.at_index((x >> 8) % m.length);
+    }
+    unsigned sum = 0;
+    double indexed = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += m.key_or(keys[i], 0);
+        }
+    });
+    constexpr unsigned sample = probes / 1024;
+    double scanned = time_probes([&] {
+        for (unsigned i = 0; i < sample; ++i) {
+            unsigned j = 0;
+            while (j < m.length && m.at_index(j) != keys[i]) {
+                ++j;
+            }
+            sum += m.key_at_index(j);
+        }
+    }) * (probes / sample);
+    std::cout << name << "\t" << indexed << " ns\t" << scanned << " ns\t" << sum << '\n';
+}
+
+const char* words[probes];
+
+//fill words with random header names, 1 in 4 of them missing
+void make_words() {
+    static const char* const missing[4] = { "X-Forwarded-For", "Origin", "DNT", "Accept-Datetime" };
+    unsigned x = 12345;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        words[i] = (i % 4) ? header_names[(x >> 8) % headers] : missing[(x >> 8) % 4];
+    }
+}
+
+//print the time of looking up a const char* in m
+template <class Map>
+void strings(const char* name, const Map& m) {
+    unsigned sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += m.get_or(words[i], 0);
+        }
+    });
+    std::cout << name << "\t" << single << " ns\t" << sum << '\n';
+}
+
+//the same with a std::unordered_map, which makes a std::string of each
+//probe
+void strings_unordered() {
+    std::unordered_map<std::string, unsigned> m;
+    for (unsigned i = 0; i < headers; ++i) {
+        m.emplace(header_names[i], map_headers.at_index(i));
+    }
+    unsigned sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            auto it = m.find(words[i]);
+            sum += (it != m.end()) ? it->second : 0;
+        }
+    });
+    std::cout << "unordered_map\t" << single << " ns\t" << sum << '\n';
+}
+
+//reads a descriptor in place
+template <unsigned Words>
+unsigned inspect(const descriptor<Words>& d) {
+    return d.words[0] + d.words[Words - 1];
+}
+
+//called through a volatile pointer, so the compiler cannot see which
+//words are read, as with code in another library
+template <unsigned Words>
+unsigned (*volatile inspector)(const descriptor<Words>&) = inspect<Words>;
+
+//what a lookup that returned a copy did
+template <class Map>
+typename Map::value_type copy_of(const Map& m, typename Map::key_type k) {
+    return m[k];
+}
+
+//print the time of passing looked up values to inspect() by reference
+//and as copies
+template <unsigned Words, class Map>
+void large_values(const char* name, const Map& m) {
+    unsigned x = 12345;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        keys[i] = m.key_at_index((x >> 8) % m.length);
+    }
+    unsigned sum = 0;
+    double referenced = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += inspector<Words>(m[keys[i]]);
+        }
+    });
+    double copied = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += inspector<Words>(copy_of(m, keys[i]));
+        }
+    });
+    std::cout << name << "\t" << referenced << " ns\t" << copied << " ns\t" << sum << '\n';
+}
+
+unsigned first_of(unsigned v) {
+    return v;
+}
+
+unsigned first_of(const descriptor<16>& d) {
+    return d.words[0];
+}
+
+//time hits that read the first word of the value
+template <class Map>
+double first_words(const Map& m, unsigned& sum) {
+    return time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += first_of(m[keys[i]]);
+        }
+    });
+}
+
+//print the time of hits in maps that differ only in their layout
+template <class Separate, class Interleaved>
+void layouts(const char* name, const Separate& separate, const Interleaved& interleaved) {
+    make_keys(separate);
+    unsigned sum = 0;
+    double apart = first_words(separate, sum);
+    double together = first_words(interleaved, sum);
+    std::cout << name << "\t" << apart << " ns\t" << together << " ns\t-\t" << sum << '\n';
+}
+
+template <class Separate, class Interleaved, class HotCold>
+void layouts(const char* name, const Separate& separate, const Interleaved& interleaved,
+    const HotCold& hot_cold)
+{
+    make_keys(separate);
+    unsigned sum = 0;
+    double apart = first_words(separate, sum);
+    double together = first_words(interleaved, sum);
+    double hot = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += hot_cold.hot(keys[i]);
+        }
+    });
+    std::cout << name << "\t" << apart << " ns\t" << together << " ns\t" << hot << " ns\t"
+        << sum << '\n';
+}
+
+//fill keys with random message types below n
+void make_types(unsigned n) {
+    unsigned x = 12345;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        keys[i] = (x >> 8) % n;
+    }
+}
+
+//time handling the messages in keys with call(type, payload)
+template <class Call>
+double route_messages(Call call, unsigned& sum) {
+    return time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += call(keys[i], i);
+        }
+    });
+}
+
+template <unsigned N, class Mode>
+double routed(const dispatch_table<N, on_message, Mode>& route, unsigned& sum) {
+    make_types(N);
+    return route_messages([&](unsigned type, unsigned payload) {
+        return route.call(type, payload);
+    }, sum);
+}
+
+template <class Handlers>
+double virtual_calls(const Handlers& handlers, unsigned n, unsigned& sum) {
+    make_types(n);
+    return route_messages([&](unsigned type, unsigned payload) {
+        return handlers.table[type]->run(payload);
+    }, sum);
+}
+
+#if __cplusplus >= 201703L
+//a message of type I, as an alternative of a std::variant
+template <unsigned I>
+struct message {
+    static constexpr unsigned type = I;
+    unsigned payload;
+};
+
+template <unsigned... Is>
+double visited(std::integer_sequence<unsigned, Is...>, unsigned& sum) {
+    typedef std::variant<message<Is>...> any_message;
+    constexpr any_message (*make[])(unsigned) = {
+        [](unsigned payload) { return any_message(message<Is>{ payload }); }...
+    };
+    make_types(sizeof...(Is));
+    std::vector<any_message> messages;
+    messages.reserve(probes);
+    for (unsigned i = 0; i < probes; ++i) {
+        messages.push_back(make[keys[i]](i));
+    }
+    return time_probes([&] {
+        for (const any_message& m : messages) {
+            sum += std::visit([](auto msg) {
+                return on_message<decltype(msg)::type>::run(msg.payload);
+            }, m);
+        }
+    });
+}
+#endif
+
+//print the time of routing each message to the handler of its type
+void dispatch() {
+    unsigned sum = 0;
+    double switched = routed(route_switched, sum);
+    double small = routed(route_small, sum);
+    double large = routed(route_large, sum);
+    std::cout << "switch\t" << switched << " ns\t-\n";
+    std::cout << "table\t" << small << " ns\t" << large << " ns\n";
+    small = virtual_calls(virtual_small, 8, sum);
+    large = virtual_calls(virtual_large, 64, sum);
+    std::cout << "virtual\t" << small << " ns\t" << large << " ns\n";
+#if __cplusplus >= 201703L
+    small = visited(std::make_integer_sequence<unsigned, 8>(), sum);
+    large = visited(std::make_integer_sequence<unsigned, 64>(), sum);
+    std::cout << "std::variant\t" << small << " ns\t" << large << " ns\n";
+#endif
+    std::cout << "checksum\t" << sum << '\n';
+}
+
+//print the time of a lookup when the ith key from the end is looked up
+//with probability 2^-(i + 1)
+template <class Map>
+void skewed(const char* name, const Map& m) {
+    unsigned x = 12345;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        const unsigned rank = __builtin_ctz((x >> 8) | (1U << 20));
+        keys[i] = m.key_at_index(rank < verbs ? verbs - 1 - rank : 0);
+    }
+    unsigned sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += m[keys[i]];
+        }
+    });
+    std::cout << name << "\t" << single << " ns\t" << sum << '\n';
+}
+
+double xs[probes];
+double ys[probes];
+
+//print the throughput of evaluate() and of calling the table per point
+template <class Table>
+void approximation(const char* name, const Table& t) {
+    unsigned x = 12345;
+    for (unsigned i = 0; i < probes; ++i) {
+        x = x * 1103515245U + 12345U;
+        xs[i] = (x >> 8) * (8.0 / (1U << 24));
+        ys[i] = 0;
+    }
+    double sum = 0;
+    double single = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            sum += t(xs[i]);
+        }
+    });
+    double bulk = time_probes([&] { t.evaluate(xs, ys, probes); });
+    std::cout << name << "\t" << single << " ns\t" << bulk << " ns\t"
+        << t.max_error() << '\n';
+    std::cout << name << "\tchecksum\t" << (sum + ys[probes - 1]) << '\n';
+}
+
+//print the time of a 3x3x3 stencil fetch, visiting the cells in index
+//order and in random order
+template <class Grid>
+void stencil(const char* name, const Grid& g) {
+    float sum = 0;
+    float out[27];
+    double sweep = time_probes([&] {
+        unsigned done = 0;
+        while (done < probes) {
+            for (unsigned x = 0; x < side && done < probes; ++x) {
+                for (unsigned y = 0; y < side && done < probes; ++y) {
+                    for (unsigned z = 0; z < side && done < probes; ++z, ++done) {
+                        const unsigned centre[3] = { x, y, z };
+                        g.neighbourhood(centre, out);
+                        sum += out[0] + out[13] + out[26];
+                    }
+                }
+            }
+        }
+    });
+    unsigned r = 12345;
+    double scattered = time_probes([&] {
+        for (unsigned i = 0; i < probes; ++i) {
+            r = r * 1103515245U + 12345U;
+            const unsigned centre[3] = { (r >> 8) % side, (r >> 14) % side, (r >> 20) % side };
+            g.neighbourhood(centre, out);
+            sum += out[0] + out[13] + out[26];
+        }
+    });
+    std::cout << name << "\t" << sweep << " ns\t" << scattered << " ns\t" << sum << '\n';
+}
+
+int main() {
+    std::cout << "N = " << num << ", " << probes << " probes per run\n";
+    std::cout << "map\twidth\ttime per lookup\n";
+    curve("binary", map_binary);
+    curve("eytzinger", map_eytzinger);
+    curve("interpolation", map_learned);
+    curve("direct", map_direct);
+    curve("hashed", map_hashed);
+#ifdef BENCH_LARGE_N
+    curve("large eytzinger", map_large_eytzinger);
+    curve("large hashed", map_large_hashed);
+#endif
+    std::cout << "instrumentation\tsingle\tbatch\tsize\tchecksum\n";
+    instrumented("eytzinger", map_eytzinger);
+    instrumented("eytzinger+counted", map_eytzinger_counted);
+    instrumented("hashed", map_hashed);
+    instrumented("hashed+counted", map_hashed_counted);
+    dump_lookup_stats(std::cout);
+    std::cout << "value to key\tindex\tscan\tchecksum\n";
+    reverse("sorted", map_reverse_sorted);
+    reverse("hashed", map_reverse_hashed);
+    std::cout << "large values\treference\tcopy\tchecksum\n";
+    large_values<16>("table 64 B", table_descriptors);
+    large_values<16>("hashed 64 B", map_descriptors);
+    large_values<64>("table 256 B", table_descriptors_large);
+    large_values<64>("hashed 256 B", map_descriptors_large);
+    std::cout << "hashed hits\tseparate\tinterleaved\thot/cold\tchecksum\n";
+    layouts("4 B values", map_hashed, map_hashed_interleaved);
+    layouts("64 B values", map_layout_separate, map_layout_interleaved, map_layout_hot_cold);
+    std::cout << "dispatch\t8 types\t64 types\n";
+    dispatch();
+    std::cout << "header names\ttime per lookup\tchecksum\n";
+    make_words();
+    strings("hashed", map_headers);
+    strings("sorted", map_headers_sorted);
+    strings("linear", map_headers_linear);
+    strings_unordered();
+    std::cout << "skewed keys\ttime per lookup\tchecksum\n";
+    skewed("generator order", map_verbs);
+    skewed("profiled", map_verbs_profiled);
+    std::cout << "mostly misses\tsingle\tbatch\tfilter\tchecksum\n";
+    misses("hashed", map_hashed);
+    misses("hashed+bloom", map_hashed_filtered);
+    misses("eytzinger", map_eytzinger);
+    misses("eytzinger+bloom", map_eytzinger_filtered);
+    std::cout << "sparse keys\ttime per lookup\tsize\tchecksum\n";
+    sparse("searched", map_sparse_searched);
+    sparse("rank", map_sparse);
+    std::cout << "grid layout\tsweep\tscattered\tchecksum\n";
+    stencil("row-major", grid_rows);
+    stencil("tiled", grid_tiles);
+    stencil("morton", grid_morton);
+    std::cout << "interpolation\tsingle\tevaluate\tmax error\n";
+    approximation("nearest", table_nearest);
+    approximation("linear", table_linear);
+    approximation("cubic", table_cubic);
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//measures how long the compiler takes to build static_table and
+//static_map instances of growing size, and how much memory it needs.
+//
+//build and run from this directory, e.g.
+//  g++ -std=c++14 -O2 -o build_bench static_table_build_bench.cpp
+//  ./build_bench g++ 1048576 -fconstexpr-loop-limit=16777216 -fconstexpr-ops-limit=4294967296
+//
+//the first argument is the compiler (default c++), the second the
+//largest N to try (default 65536) and the rest are passed to the
+//compiler.  Past a few hundred thousand entries GCC needs larger
+//-fconstexpr-loop-limit and -fconstexpr-ops-limit values, and Clang a
+//larger -fconstexpr-steps.
+
+static const char* const source = "static_table_build_bench_tu.cpp";
+
+struct kind {
+    const char* name;
+    const char* decl;
+};
+
+//each declaration is compiled with N, keys and values defined
+static const kind kinds[] = {
+    { "table", "constexpr static_table<N, values> m{};" },
+    { "sorted", "constexpr static_map<N, sorted_keys, values> m{};" },
+    { "hashed", "constexpr static_map<N, scattered_keys, values> m{};" },
+};
+
+//write a translation unit that builds one table of n entries
+static bool write_source(const kind& k, unsigned n) {
+    FILE* f = std::fopen(source, "w");
+    if (!f) {
+        return false;
+    }
+    std::fprintf(f,
+        "#include \"static_table.h\"\n"
+        "constexpr unsigned N = %u;\n"
+        "struct sorted_keys {\n"
+        "    constexpr unsigned operator()(unsigned i) const { return 2*i + 1; }\n"
+        "};\n"
+        "struct scattered_keys {\n"
+        "    constexpr unsigned operator()(unsigned i) const { return i * 2654435761U; }\n"
+        "};\n"
+        "struct values {\n"
+        "    constexpr unsigned operator()(unsigned i) const { return i ^ (i >> 7); }\n"
+        "};\n"
+        "%s\n"
+        "unsigned probe(unsigned i) { return m[i]; }\n",
+        n, k.decl);
+    return std::fclose(f) == 0;
+}
+
+struct result {
+    bool ok;
+    double seconds;
+    long peak_kb;
+};
+
+//compile the translation unit, timing the compiler and recording its
+//peak resident set size
+static result compile(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const std::string& a : args) {
+        argv.push_back(const_cast<char*>(a.c_str()));
+    }
+    argv.push_back(nullptr);
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        //keep the diagnostics of failed builds out of the table
+        FILE* null = std::freopen("/dev/null", "w", stderr);
+        (void)null;
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    result r = { false, 0, 0 };
+    if (pid < 0) {
+        return r;
+    }
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        return r;
+    }
+    auto stop = std::chrono::steady_clock::now();
+    r.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    r.seconds = std::chrono::duration<double>(stop - start).count();
+    //ru_maxrss is in kilobytes on Linux
+    r.peak_kb = usage.ru_maxrss;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    std::string cxx = (argc > 1) ? argv[1] : "c++";
+    unsigned max_n = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 65536;
+    std::vector<std::string> args = { cxx, "-std=c++14", "-O2", "-c",
+        "-o", "/dev/null" };
+    for (int i = 3; i < argc; ++i) {
+        args.push_back(argv[i]);
+    }
+    args.push_back(source);
+    std::cout << "kind\tN\tseconds\tpeak RSS (MB)\n";
+    for (const kind& k : kinds) {
+        bool failed = false;
+        for (unsigned n = 256; n <= max_n && !failed; n *= 4) {
+            if (!write_source(k, n)) {
+                std::cerr << "cannot write " << source << '\n';
+                return 1;
+            }
+            result r = compile(args);
+            std::cout << k.name << '\t' << n << '\t';
+            if (r.ok) {
+                std::cout << r.seconds << '\t' << r.peak_kb / 1024.0 << std::endl;
+            }
+            else {
+                //larger tables will fail too, so move on
+                std::cout << "failed" << std::endl;
+                failed = true;
+            }
+        }
+    }
+    std::remove(source);
+    return 0;
+}
@@ -0,0 +1,126 @@
+//built without the standard library or exceptions by
+//static_table_freestanding_test.sh, which checks that every table below
+//is initialized at compile time and stored in a read-only section
+#include "static_table.h"
+#include "metaprogramming.h"
+
+constexpr unsigned num = 100;
+
+struct keymap_scrambled {
+    constexpr unsigned operator()(unsigned i) {
+        return (i * 37) % num;
+    }
+};
+
+struct keymap_sorted {
+    constexpr unsigned operator()(unsigned i) {
+        return i * i;
+    }
+};
+
+struct valuemap {
+    constexpr unsigned operator()(unsigned key) {
+        return key*key;
+    }
+};
+
+constexpr unsigned headers = 4;
+constexpr const char* header_names[headers] = { "Host", "Accept", "Cookie", "User-Agent" };
+
+struct header_keys {
+    constexpr static_string operator()(unsigned i) {
+        return header_names[i];
+    }
+};
+
+struct header_length {
+    constexpr unsigned operator()(static_string name) {
+        return name.size();
+    }
+};
+
+struct domain {
+    static constexpr double lo = 0;
+    static constexpr double hi = 4;
+};
+
+struct curve {
+    constexpr double operator()(double x) {
+        return x / (1 + x*x);
+    }
+};
+
+struct cellmap {
+    constexpr unsigned operator()(unsigned x, unsigned y) {
+        return x*10 + y;
+    }
+};
+
+template <unsigned I>
+struct on_message {
+    static unsigned run(unsigned payload) {
+        return payload * 10 + I;
+    }
+};
+
+//declared extern so that they are emitted with names the script can find
+extern const static_table<num, valuemap> freestanding_table;
+extern const packed_static_table<num, valuemap> freestanding_packed;
+extern const static_map<num, keymap_scrambled, valuemap> freestanding_hashed;
+extern const static_map<num, keymap_sorted, valuemap> freestanding_sorted;
+extern const static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::bloom<100>, static_instrument::none, static_reverse::hashed,
+    static_storage::separate> freestanding_filtered;
+extern const static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::none, static_instrument::none, static_reverse::none,
+    static_storage::interleaved> freestanding_interleaved;
+extern const static_map<headers, header_keys, header_length> freestanding_headers;
+extern const sparse_static_map<num, keymap_sorted, valuemap> freestanding_sparse;
+extern const interpolated_table<64, curve, domain> freestanding_curve;
+extern const static_grid<cellmap, static_layout::morton, 10, 10> freestanding_grid;
+extern const dispatch_table<4, on_message, static_dispatch::table> freestanding_routes;
+
+constexpr static_table<num, valuemap> freestanding_table;
+constexpr packed_static_table<num, valuemap> freestanding_packed;
+constexpr static_map<num, keymap_scrambled, valuemap> freestanding_hashed;
+constexpr static_map<num, keymap_sorted, valuemap> freestanding_sorted;
+constexpr static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::bloom<100>, static_instrument::none, static_reverse::hashed,
+    static_storage::separate> freestanding_filtered;
+constexpr static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::none, static_instrument::none, static_reverse::none,
+    static_storage::interleaved> freestanding_interleaved;
+constexpr static_map<headers, header_keys, header_length> freestanding_headers;
+constexpr sparse_static_map<num, keymap_sorted, valuemap> freestanding_sparse;
+constexpr interpolated_table<64, curve, domain> freestanding_curve;
+constexpr static_grid<cellmap, static_layout::morton, 10, 10> freestanding_grid;
+constexpr dispatch_table<4, on_message, static_dispatch::table> freestanding_routes;
+
+static_assert(freestanding_hashed[37] == 37*37 && freestanding_sorted[81] == 81*81 &&
+    freestanding_headers["Cookie"] == 6 && *freestanding_filtered.find_key(49) == 7 &&
+    freestanding_grid(3, 4) == 34, "lookups at compile time");
+
+//the lookups, including the ones that would throw, compiled without
+//exceptions
+unsigned look_up(unsigned k) {
+    return freestanding_table[k] + freestanding_packed[k] + freestanding_hashed[k] +
+        freestanding_sorted[k] + freestanding_filtered.get_or(k, 0) + freestanding_interleaved[k] +
+        freestanding_sparse[k] + freestanding_grid(k % 10, k / 10 % 10);
+}
+
+unsigned look_up_header(const char* name, unsigned length) {
+    return freestanding_headers[static_string(name, length)];
+}
+
+void look_up_batch(const unsigned* keys, unsigned* values, unsigned n) {
+    freestanding_hashed.lookup(keys, values, n);
+    freestanding_sparse.lookup(keys, values, n);
+}
+
+double evaluate(double x) {
+    return freestanding_curve(x);
+}
+
+unsigned route(unsigned type, unsigned payload) {
+    return freestanding_routes.call(type, payload);
+}
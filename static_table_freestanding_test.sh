@@ -0,0 +1,59 @@
+#!/bin/sh
+#build static_table_freestanding_test.cpp without the standard library
+#or exceptions, and check in the object file that its tables need no
+#initialization at runtime and are stored in read-only sections.
+#set CXX to use another compiler.
+
+CXX=${CXX:-g++}
+FLAGS="-std=c++14 -O2 -ffreestanding -fno-exceptions -fno-rtti -DNO_STDLIB"
+SOURCE=static_table_freestanding_test.cpp
+OBJECT=static_table_freestanding_test.o
+status=0
+
+check() {
+    if [ "$2" = 1 ]; then
+        echo "$1: 1"
+    else
+        echo "$1: 0"
+        status=1
+    fi
+}
+
+#only headers that a freestanding implementation provides.  The
+#dependencies are listed first, as a failure inside $() is not seen
+if headers=$($CXX $FLAGS -M $SOURCE); then
+    hosted=$(echo "$headers" | tr ' ' '\n' |
+        grep -E '/(stdexcept|exception|iterator|string|string_view|new|cstdlib)$')
+    check "Freestanding headers only" "$([ -z "$hosted" ] && echo 1)"
+else
+    check "Headers listed" 0
+fi
+
+#position dependent code keeps the tables in .rodata.  Position
+#independent code moves the ones holding pointers to .data.rel.ro, which
+#is read-only after relocation
+for pic in -fno-pie -fpie; do
+    if ! $CXX $FLAGS $pic -c $SOURCE -o $OBJECT; then
+        check "Builds with $pic" 0
+        continue
+    fi
+    if [ $pic = -fno-pie ]; then
+        sections='^\.rodata'
+    else
+        sections='^(\.rodata|\.data\.rel\.ro)'
+    fi
+    tables=$(nm -f sysv $OBJECT | grep '^freestanding_' | wc -l)
+    misplaced=$(nm -f sysv $OBJECT | grep '^freestanding_' |
+        awk -F'|' '{ gsub(/ /, "", $7); print $7 }' | grep -Ev "$sections")
+    check "Tables found with $pic" "$([ "$tables" -eq 11 ] && echo 1)"
+    check "Read-only tables with $pic" "$([ -z "$misplaced" ] && echo 1)"
+    initializers=$(readelf -SW $OBJECT | grep -E '\.(init_array|preinit_array|ctors)')
+    constructors=$(nm $OBJECT | grep '_GLOBAL__sub_I')
+    check "No dynamic initialization with $pic" \
+        "$([ -z "$initializers" ] && [ -z "$constructors" ] && echo 1)"
+    #nothing to link against: no exception, guard or runtime functions
+    check "No undefined symbols with $pic" "$([ -z "$(nm -u $OBJECT)" ] && echo 1)"
+done
+
+rm -f $OBJECT
+exit $status
@@ -1,5 +1,7 @@
 #include "static_table.h"
 #include <iostream>
+#include <sstream>
+#include <string>
 
 constexpr unsigned num = 100;
 
@@ -16,6 +18,18 @@ struct keymap_reverse {
     }
 };
 
+struct keymap_scrambled {
+    constexpr unsigned operator()(unsigned i) {
+        return (i * 37) % num;
+    }
+};
+
+struct keymap_squares {
+    constexpr unsigned operator()(unsigned i) {
+        return i * i;
+    }
+};
+
 struct valuemap {
     constexpr unsigned operator()(unsigned key) {
         return key*key;
@@ -24,12 +38,558 @@ struct valuemap {
 
 constexpr static_map<num, keymap, valuemap> map;
 constexpr static_map<num, keymap_reverse, valuemap> map_reverse;
+constexpr static_map<num, keymap_scrambled, valuemap> map_hashed;
+constexpr static_map<num, keymap, valuemap, static_search::eytzinger> map_eytzinger;
+constexpr static_map<num, keymap_reverse, valuemap, static_search::linear> map_linear;
+constexpr static_map<num, keymap, valuemap, static_search::interpolation> map_learned;
+constexpr static_map<num, keymap_squares, valuemap, static_search::interpolation> map_learned_squares;
+constexpr static_map<num, keymap_squares, valuemap, static_search::binary> map_binary;
 constexpr static_table<num, valuemap> table;
 
+constexpr static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::bloom<>> map_filtered;
+constexpr static_map<num, keymap_squares, valuemap, static_search::linear,
+    static_filter::bloom<1000>> map_filtered_linear;
+
+static_assert(map_filtered.filtered && !map.filtered && map.filter_fpr == 1 && map.filter_bytes == 0,
+    "filter selection");
+static_assert(map_filtered.filter_fpr <= 0.01 && map_filtered_linear.filter_fpr <= 0.001 &&
+    map_filtered.filter_bytes < map_filtered_linear.filter_bytes, "filter sizing");
+static_assert(map_filtered[74] == 74*74 && !map_filtered.contains(num) && map_filtered.get_or(num, 7) == 7 &&
+    *map_filtered_linear.find(81) == 81*81 && !map_filtered_linear.find(82), "filtered lookup");
+
+//the last keys are the hottest
+struct profile_reversed {
+    constexpr unsigned operator()(unsigned i) {
+        return i;
+    }
+};
+
+constexpr static_map<num, keymap, valuemap, static_search::profiled<profile_reversed>> map_profiled;
+
+static_assert(map_profiled[37] == 37*37 && !map_profiled.contains(num) &&
+    map_profiled.key_at_index(3) == 3 && map_profiled.at_index(3) == 9, "profiled lookup");
+static_assert(map_profiled.lower_bound(40) == 40 && map_profiled.keys()[40] == 40 &&
+    !map_profiled.keys().contiguous(), "profiled range queries");
+
+//every last digit is the value of 10 keys
+struct valuemap_digit {
+    constexpr unsigned operator()(unsigned key) {
+        return key % 10;
+    }
+};
+
+constexpr static_map<num, keymap_scrambled, valuemap_digit, static_search::automatic,
+    static_filter::none, static_instrument::none, static_reverse::sorted> map_digits_sorted;
+constexpr static_map<num, keymap_scrambled, valuemap_digit, static_search::automatic,
+    static_filter::none, static_instrument::none, static_reverse::hashed> map_digits_hashed;
+constexpr static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::none, static_instrument::none, static_reverse::hashed> map_squares_hashed;
+
+static_assert(map_digits_sorted.reversed && !map.reversed, "reverse selection");
+//keymap_scrambled generates 0, 37, 74, 11, ... so 7 is first reached by 37
+static_assert(map_digits_sorted.keys_of(7).size() == 10 && map_digits_sorted.keys_of(7)[0] == 37 &&
+    map_digits_hashed.keys_of(7).size() == 10 && *map_digits_hashed.find_key(7) == 37 &&
+    map_digits_sorted.keys_of(10).size() == 0 && !map_digits_hashed.contains_value(10),
+    "reverse lookup of repeated values");
+static_assert(map_squares_hashed.key_or(49, num) == 7 && map_squares_hashed.key_or(50, num) == num &&
+    map_squares_hashed.keys_of(81).size() == 1, "reverse lookup of unique values");
+
+constexpr unsigned headers = 12;
+constexpr const char* header_names[headers] = { "Host", "Accept", "Accept-Encoding",
+    "Accept-Language", "Cache-Control", "Connection", "Content-Length", "Content-Type",
+    "Cookie", "User-Agent", "If-None-Match", "If-Modified-Since" };
+
+struct header_keys {
+    constexpr static_string operator()(unsigned i) {
+        return header_names[i];
+    }
+};
+
+//the position of a header in header_names
+struct header_index {
+    constexpr unsigned operator()(static_string name) {
+        unsigned i = 0;
+        while (i < headers && header_names[i] != name) {
+            ++i;
+        }
+        return i;
+    }
+};
+
+constexpr static_map<headers, header_keys, header_index> map_headers;
+constexpr static_map<headers, header_keys, header_index, static_search::sort> map_headers_sorted;
+constexpr static_map<headers, header_keys, header_index, static_search::linear> map_headers_linear;
+
+static_assert(map_headers.hashed && map_headers_sorted.permuted, "string strategies");
+static_assert(map_headers["Content-Type"] == 7 && map_headers_sorted["Host"] == 0 &&
+    !map_headers.contains("Content-Typ") && map_headers.get_or("content-type", 99) == 99 &&
+    map_headers_sorted.keys()[0] == "Accept" && static_string("Accept") < "Accept-Encoding",
+    "string lookup");
+
+#if __cplusplus >= 201703L
+struct header_views {
+    constexpr std::string_view operator()(unsigned i) {
+        return header_names[i];
+    }
+};
+
+struct header_length {
+    constexpr std::size_t operator()(std::string_view name) {
+        return name.size();
+    }
+};
+
+constexpr static_map<headers, header_views, header_length> map_header_views;
+
+static_assert(map_header_views.hashed && map_header_views["Cookie"] == 6 &&
+    !map_header_views.contains("Cookies"), "string_view lookup");
+#endif
+
+struct signed_valuemap {
+    constexpr int operator()(unsigned key) {
+        return static_cast<int>(key) - 50;
+    }
+};
+
+constexpr packed_static_table<num, valuemap> packed;
+constexpr packed_static_table<num, signed_valuemap> packed_signed;
+
+//a value too large to copy on every lookup
+struct descriptor {
+    unsigned words[16];
+};
+
+struct descriptormap {
+    constexpr descriptor operator()(unsigned key) {
+        descriptor d{};
+        for (unsigned j = 0; j < 16; ++j) {
+            d.words[j] = key * 16 + j;
+        }
+        return d;
+    }
+};
+
+constexpr static_map<num, keymap_scrambled, descriptormap> map_descriptors;
+constexpr static_table<num, descriptormap> table_descriptors;
+
+//lookups refer to the stored values, so they can be bound to constexpr
+//references
+constexpr const descriptor& descriptor_74 = map_descriptors[74];
+constexpr const descriptor& descriptor_3 = table_descriptors[3];
+static_assert(&descriptor_74 == &map_descriptors.at_index(2) && descriptor_74.words[15] == 74*16 + 15 &&
+    &descriptor_3 == &table_descriptors.at_index(3) && descriptor_3.words[1] == 49 &&
+    map_descriptors.key_at_index(2) == 74, "lookups by reference");
+
+//the first word of a descriptor is read far more often than the rest
+struct first_word {
+    constexpr unsigned operator()(const descriptor& d) {
+        return d.words[0];
+    }
+};
+
+constexpr static_map<num, keymap_scrambled, valuemap, static_search::automatic,
+    static_filter::none, static_instrument::none, static_reverse::none,
+    static_storage::interleaved> map_interleaved;
+constexpr static_map<num, keymap_scrambled, descriptormap, static_search::automatic,
+    static_filter::none, static_instrument::none, static_reverse::none,
+    static_storage::hot_cold<first_word>> map_hot_cold;
+
+static_assert(map_interleaved.hashed && map_interleaved[74] == 74*74 &&
+    map_interleaved.key_at_index(2) == 74 && !map_interleaved.contains(num) &&
+    map_hot_cold.hashed && map_hot_cold.hot(74) == 74*16 && map_hot_cold[74].words[15] == 74*16 + 15 &&
+    &map_hot_cold[74] == &map_hot_cold.at_index(2) && map_hot_cold.find_hot(num) == nullptr,
+    "storage layouts");
+
+//sorted keys stored interleaved still answer the ordered queries
+constexpr static_map<num, keymap_squares, valuemap, static_search::perfect_hash,
+    static_filter::none, static_instrument::none, static_reverse::none,
+    static_storage::interleaved> map_interleaved_squares;
+constexpr static_map<num, keymap_squares, descriptormap, static_search::perfect_hash,
+    static_filter::none, static_instrument::none, static_reverse::none,
+    static_storage::hot_cold<first_word>> map_hot_cold_squares;
+
+static_assert(map_interleaved_squares.lower_bound(50) == 8 && map_interleaved_squares.upper_bound(49) == 8 &&
+    map_interleaved_squares.floor(50) == 7 && map_interleaved_squares.ceiling(49) == 7 &&
+    map_interleaved_squares.equal_range(64).first == 8 && map_hot_cold_squares.lower_bound(50) == 8 &&
+    map_hot_cold_squares.upper_bound(num*num) == num, "ordered queries on storage layouts");
+
+//the handler of message type I
+template <unsigned I>
+struct on_message {
+    static constexpr unsigned run(unsigned payload) {
+        return payload * 10 + I;
+    }
+};
+
+constexpr dispatch_table<5, on_message> route_switched;
+constexpr dispatch_table<5, on_message, static_dispatch::table> route_table;
+constexpr dispatch_table<40, on_message> route_large;
+
+static_assert(route_switched.switched && !route_table.switched && !route_large.switched &&
+    route_table[3] == &on_message<3>::run && route_switched.call(4, 7) == 74 &&
+    route_table.call(2, 7) == 72 && route_large.call(39, 1) == 49, "dispatch");
+
+//every index reaches its own handler through both forms
+template <class Route>
+bool routes_agree(const Route& route) {
+    for (unsigned i = 0; i < route.length; ++i) {
+        if (route.call(i, i) != i * 11 || route[i](i) != i * 11) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct keymap_strided {
+    constexpr int operator()(unsigned i) {
+        return 1000 - 12 * static_cast<int>(i);
+    }
+};
+
+constexpr static_map<num, keymap_strided, valuemap> map_strided;
+
+struct keymap_sparse {
+    constexpr unsigned operator()(unsigned i) {
+        return (i * 37) % num * ((i * 37) % num) * 5 + 3;
+    }
+};
+
+constexpr sparse_static_map<num, keymap_sparse, valuemap> map_sparse;
+constexpr sparse_static_map<num, keymap_strided, valuemap> map_sparse_signed;
+
+static_assert(map_sparse.universe == 99*99*5 + 1 && map_sparse.reference == 3, "sparse range");
+static_assert(map_sparse[8] == 64 && map_sparse[37*37*5 + 3] == (37*37*5 + 3)*(37*37*5 + 3) &&
+    !map_sparse.contains(9) && !map_sparse.contains(2) && !map_sparse.contains(99*99*5 + 4) &&
+    map_sparse.get_or(0, 7) == 7 && *map_sparse.find(3) == 9, "sparse lookup");
+static_assert(map_sparse.key_at_index(37) == 37*37*5 + 3 && map_sparse.at_index(1) == 64 &&
+    map_sparse.lower_bound(4) == 1 && map_sparse.lower_bound(0) == 0 &&
+    map_sparse.lower_bound(99*99*5 + 4) == num, "sparse positions are in key order");
+static_assert(map_sparse_signed[-188] == 188*188 && map_sparse_signed.key_at_index(0) == -188 &&
+    map_sparse_signed.key_at_index(num - 1) == 1000 && !map_sparse_signed.contains(-187),
+    "sparse signed keys");
+
+struct keymap_fractions {
+    constexpr double operator()(unsigned i) {
+        return ((i * 37) % num) / 4.0;
+    }
+};
+
+struct valuemap_fractions {
+    constexpr double operator()(double key) {
+        return key * 2;
+    }
+};
+
+constexpr static_map<num, keymap_fractions, valuemap_fractions> map_sorted;
+
+static_assert(map_sorted.permuted && !map_sorted.sorted,
+    "unsorted keys that cannot be hashed should be sorted");
+static_assert(map_sorted[18.5] == 37 && !map_sorted.contains(18.3) && !map_sorted.contains(25), "sorted lookup");
+static_assert(map_sorted.key_at_index(2) == 18.5 && map_sorted.at_index(2) == 37,
+    "sorted map keeps generator order");
+constexpr static_map<num, keymap_scrambled, valuemap, static_search::sort> map_forced_sort;
+
+static_assert(map_forced_sort[74] == 74*74 && map_forced_sort.key_at_index(2) == 74,
+    "forced sort");
+
+static_assert(map.direct && map_reverse.direct && map_strided.direct,
+    "keys in arithmetic progression should be indexed directly");
+static_assert(map_strided[556] == 556*556 && map_strided.key_at_index(37) == 556 && !map_strided.contains(1000 - 12*37 + 6) &&
+    !map_strided.contains(1012) && !map_strided.contains(1000 - 12*num), "direct lookup");
+static_assert(map_hashed.hashed, "unsorted integer keys should be hashed");
+static_assert(map_hashed[74] == 74*74, "perfect hash lookup");
+static_assert(map_hashed.at_index(2) == 74*74, "at_index keeps generator order");
+static_assert(map_hashed.key_at_index(2) == 74, "key_at_index keeps generator order");
+static_assert(map_eytzinger[37] == 37*37, "eytzinger lookup");
+static_assert(map_eytzinger.key_at_index(37) == 37, "eytzinger keeps generator order");
+static_assert(map_learned.max_error() == 0 && map_learned[37] == 37*37, "learned lookup");
+static_assert(map_learned_squares[81*81] == 81*81*81*81 && !map_learned_squares.contains(82),
+    "learned lookup of nonlinear keys");
+static_assert(map_learned_squares.max_error() < 16, "learned index error bound");
+static_assert(map.contains(42) && !map.contains(num) && !map_linear.contains(num), "contains");
+static_assert(map_reverse.get_or(num, 7) == 7, "get_or miss");
+static_assert(map_hashed.get_or(9, 7) == 81, "get_or hit");
+static_assert(*map_eytzinger.find(5) == 25 && !map_eytzinger.find(num), "find");
+static_assert(!table.contains(num) && table.get_or(num, 7) == 7, "table compatibility");
+static_assert(packed.bits == 14 && packed[37] == 37*37 && packed[99] == 99*99, "packed lookup");
+static_assert(packed_signed.bits == 7 && packed_signed.reference == -50 &&
+    packed_signed[3] == -47, "packed signed lookup");
+
+static_assert(map.lower_bound(37) == 37 && map.upper_bound(37) == 38 &&
+    map.floor(num + 5) == num - 1 && map.ceiling(num) == num, "direct range queries");
+static_assert(map_learned_squares.lower_bound(50) == 8 && map_learned_squares.floor(50) == 7 &&
+    map_learned_squares.equal_range(49).first == 7 && map_learned_squares.equal_range(49).second == 8,
+    "learned range queries");
+static_assert(map_eytzinger.lower_bound(20) == 20 && map_eytzinger.keys()[20] == 20 &&
+    map_eytzinger.values().back() == (num - 1)*(num - 1) && !map_eytzinger.values().contiguous(),
+    "eytzinger range queries");
+static_assert(map_sorted.ceiling(18.3) == 74 && map_sorted.keys()[74] == 18.5 &&
+    map_sorted.floor(-1) == num && map_sorted.values().contiguous(), "sorted range queries");
+
+struct unit_domain {
+    static constexpr double lo = -1;
+    static constexpr double hi = 3;
+};
+
+struct curve {
+    constexpr double operator()(double x) {
+        return x / (1 + x*x);
+    }
+};
+
+constexpr interpolated_table<64, curve, unit_domain, static_interpolation::nearest> curve_nearest;
+constexpr interpolated_table<64, curve, unit_domain> curve_linear;
+constexpr interpolated_table<64, curve, unit_domain, static_interpolation::cubic> curve_cubic;
+
+static_assert(curve_linear(-1) == curve{}(-1) && curve_cubic(-1) == curve{}(-1) &&
+    curve_linear(-5) == curve_linear(-1) && curve_nearest(1e9) == curve{}(3), "interpolation ends");
+static_assert(curve_cubic.max_error() < curve_linear.max_error() &&
+    curve_linear.max_error() < curve_nearest.max_error() && curve_cubic.max_error() < 1e-3,
+    "interpolation error");
+
+//check that bulk evaluation agrees with operator() across and beyond
+//the domain
+template <class Table>
+bool evaluate_agrees(const Table& t) {
+    double xs[2*num + 1];
+    double ys[2*num + 1];
+    for (unsigned i = 0; i <= 2*num; ++i) {
+        xs[i] = -2 + 6.0 * i / (2*num);
+    }
+    t.evaluate(xs, ys, 2*num + 1);
+    for (unsigned i = 0; i <= 2*num; ++i) {
+        if (ys[i] != t(xs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct cellmap {
+    constexpr unsigned operator()(unsigned x, unsigned y, unsigned z) {
+        return x*100 + y*10 + z;
+    }
+};
+
+constexpr static_grid<cellmap, static_layout::row_major, 5, 6, 7> grid_rows;
+constexpr static_grid<cellmap, static_layout::tiled<4>, 5, 6, 7> grid_tiles;
+constexpr static_grid<cellmap, static_layout::morton, 5, 6, 7> grid_morton;
+
+static_assert(grid_rows(4, 5, 6) == 456 && grid_tiles(4, 5, 6) == 456 && grid_morton(1, 2, 3) == 123,
+    "grid lookup");
+static_assert(grid_rows.storage == 210 && grid_tiles.storage == 512 && grid_morton.storage == 512,
+    "grid padding");
+//Z-order: the bits of z, y and x interleave from the lowest up
+static_assert(grid_morton.offset_of(0, 0, 1) == 1 && grid_morton.offset_of(0, 1, 0) == 2 &&
+    grid_morton.offset_of(1, 0, 0) == 4 && grid_morton.offset_of(1, 1, 1) == 7 &&
+    grid_morton.offset_of(0, 0, 2) == 8, "morton order");
+
+//check that every neighbourhood matches clamped lookups
+template <class Grid>
+bool neighbourhoods_agree(const Grid& g) {
+    unsigned out[27];
+    for (unsigned x = 0; x < 5; ++x) {
+        for (unsigned y = 0; y < 6; ++y) {
+            for (unsigned z = 0; z < 7; ++z) {
+                const unsigned centre[3] = { x, y, z };
+                g.neighbourhood(centre, out);
+                unsigned j = 0;
+                for (int dx = -1; dx <= 1; ++dx) {
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dz = -1; dz <= 1; ++dz) {
+                            const unsigned cx = (x + dx > 4) ? (dx < 0 ? 0 : 4) : x + dx;
+                            const unsigned cy = (y + dy > 5) ? (dy < 0 ? 0 : 5) : y + dy;
+                            const unsigned cz = (z + dz > 6) ? (dz < 0 ? 0 : 6) : z + dz;
+                            if (out[j++] != g(cx, cy, cz)) {
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//check that iterating over the views visits the entries in sorted order
+template <class Map>
+bool views_sorted(const Map& m) {
+    //the iterators outlive the views they came from
+    auto v = m.values().begin();
+    const auto last = m.values().end();
+    unsigned i = 0;
+    for (auto k : m.keys()) {
+        if ((i != 0 && !(m.keys()[i - 1] < k)) || *v != m[k] || m.lower_bound(k) != i) {
+            return false;
+        }
+        ++v;
+        ++i;
+    }
+    return v == last && i == num;
+}
+
+//check that decoding every range of a packed table agrees with operator[]
+template <class Table>
+bool decode_agrees(const Table& t) {
+    typename Table::value_type values[num];
+    for (unsigned first = 0; first < num; first += 7) {
+        t.decode(first, num - first, values);
+        for (unsigned i = first; i < num; ++i) {
+            if (values[i - first] != t[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//check that every header is found through each kind of probe, and that
+//near misses are not
+template <class Map>
+bool strings_agree(const Map& m) {
+    for (unsigned i = 0; i < headers; ++i) {
+        const std::string owned(header_names[i]);
+        if (m[header_names[i]] != i || *m.find(owned) != i
+            || m.get_or(static_string(owned.data(), owned.size()), headers) != i
+            || m.contains(owned + ' ') || m.contains(owned.substr(1))) {
+            return false;
+        }
+    }
+    return !m.contains("") && !m.contains("host");
+}
+
+//check the reverse lookups of every value in [0, n) against a scan of
+//the map in generator order
+template <class Map>
+bool reverse_agrees(const Map& m, unsigned n) {
+    for (unsigned v = 0; v < n; ++v) {
+        auto keys = m.keys_of(v);
+        unsigned k = 0;
+        for (unsigned i = 0; i < num; ++i) {
+            if (m.at_index(i) == v && (k == keys.size() || keys[k++] != m.key_at_index(i))) {
+                return false;
+            }
+        }
+        if (k != keys.size() || (k == 0) != (m.find_key(v) == nullptr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//count some lookups, and check the counts and what write() prints
+bool profile_counts() {
+    profile_counter<decltype(map_hashed)> counter(map_hashed);
+    profile_counter<decltype(map_hashed)> other(map_hashed);
+    for (unsigned i = 0; i < 5; ++i) {
+        counter[74];
+    }
+    counter.contains(num);
+    other.get_or(0, 1);
+    other.find(74);
+    counter.merge(other);
+    std::ostringstream out;
+    counter.write(out);
+    //74 is the 3rd key generated and 0 the 1st
+    return counter.hits_at_index(2) == 6 && counter.hits_at_index(0) == 1 &&
+        counter.misses() == 1 && out.str().compare(0, 9, "1,\n0,\n6,\n") == 0;
+}
+
+//check the results of a batch lookup of every key in [0, n) against
+//operator[]
+template <class Map>
+bool batch_matches(const Map& m, const unsigned* values, const bool* found, unsigned n) {
+    for (unsigned i = 0; i < n; ++i) {
+        bool hit = true;
+        unsigned expected = 0;
+        try {
+            expected = m[i];
+        }
+        catch (key_not_found_error& e) {
+            hit = false;
+        }
+        if (found[i] != hit || (hit && values[i] != expected)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class Map>
+bool batch_agrees(const Map& m, unsigned n) {
+    unsigned keys[2*num];
+    unsigned values[2*num];
+    bool found[2*num];
+    for (unsigned i = 0; i < n; ++i) {
+        keys[i] = i;
+    }
+    m.lookup(keys, values, n, found);
+    return batch_matches(m, values, found, n);
+}
+
+//the same with Width searches in lockstep.  2*num - 5 keys leave a
+//partial group for every width but 1
+template <unsigned Width, class Map>
+bool width_agrees(const Map& m) {
+    constexpr unsigned n = 2*num - 5;
+    unsigned keys[n];
+    unsigned values[n];
+    bool found[n];
+    for (unsigned i = 0; i < n; ++i) {
+        keys[i] = i;
+    }
+    m.template lookup<Width>(keys, values, n, found);
+    return batch_matches(m, values, found, n);
+}
+
+template <class Map>
+bool widths_agree(const Map& m) {
+    return width_agrees<1>(m) && width_agrees<3>(m) && width_agrees<32>(m);
+}
+
 int main() {
     std::cout << "First table sorted: " << map.sorted;
     std::cout << "\nSecond table sorted: " << map_reverse.sorted;
-    std::cout << "\nThird table sorted: " << table.sorted << '\n';
+    std::cout << "\nThird table sorted: " << map_hashed.sorted;
+    std::cout << "\nFourth table sorted: " << table.sorted;
+    std::cout << "\nBatch lookups agree: "
+        << (batch_agrees(map_linear, 2*num) && batch_agrees(map_hashed, 2*num)
+            && batch_agrees(table, num) && batch_agrees(map_learned, 2*num)
+            && batch_agrees(map_learned_squares, 2*num) && batch_agrees(map, 2*num)
+            && batch_agrees(map_reverse, 2*num) && batch_agrees(map_forced_sort, 2*num)
+            && batch_agrees(map_sparse, 2*num) && batch_agrees(map_filtered, 2*num)
+            && batch_agrees(map_filtered_linear, 2*num) && batch_agrees(map_profiled, 2*num)
+            && batch_agrees(map_interleaved, 2*num))
+        << '\n';
+    std::cout << "Batch widths agree: "
+        << (widths_agree(map_linear) && widths_agree(map_hashed) && widths_agree(map_eytzinger)
+            && widths_agree(map_learned_squares) && widths_agree(map_forced_sort)
+            && widths_agree(map_filtered) && widths_agree(map_interleaved)
+            && widths_agree(map_binary)) << '\n';
+    std::cout << "Sorted views agree: "
+        << (views_sorted(map) && views_sorted(map_eytzinger) && views_sorted(map_sorted)
+            && views_sorted(map_learned_squares) && views_sorted(map_forced_sort)
+            && views_sorted(map_profiled)) << '\n';
+    std::cout << "Profile counts: " << profile_counts() << '\n';
+    std::cout << "String lookups agree: "
+        << (strings_agree(map_headers) && strings_agree(map_headers_sorted)
+            && strings_agree(map_headers_linear)) << '\n';
+    std::cout << "Reverse lookups agree: "
+        << (reverse_agrees(map_digits_sorted, 20) && reverse_agrees(map_digits_hashed, 20)
+            && reverse_agrees(map_squares_hashed, num * num)) << '\n';
+    std::cout << "Dispatch agrees: "
+        << (routes_agree(route_switched) && routes_agree(route_table)
+            && routes_agree(route_large)) << '\n';
+    std::cout << "Packed decode agrees: "
+        << (decode_agrees(packed) && decode_agrees(packed_signed)) << '\n';
+    std::cout << "Grid neighbourhoods agree: "
+        << (neighbourhoods_agree(grid_rows) && neighbourhoods_agree(grid_tiles)
+            && neighbourhoods_agree(grid_morton)) << '\n';
+    std::cout << "Interpolated evaluate agrees: "
+        << (evaluate_agrees(curve_nearest) && evaluate_agrees(curve_linear)
+            && evaluate_agrees(curve_cubic)) << '\n';
     unsigned num;
     while (std::cin >> num) {
         try {
@@ -44,6 +604,12 @@ int main() {
         catch (std::exception& e) {
             std::cout << "Not found\n";
         }
+        try {
+            std::cout << "Entry in map 3: " << map_hashed[num] << '\n';
+        }
+        catch (std::exception& e) {
+            std::cout << "Not found\n";
+        }
         //no bounds checking
         std::cout << "Entry in table: " << table[num] << '\n';
     }